@@ -12,14 +12,28 @@ using namespace std;
 void bidirectional_stream_copy( Socket& socket )
 {
   constexpr size_t buffer_size = 1048576;
+  constexpr size_t read_size = 65536; // each read becomes one chunk of its byte stream
 
   EventLoop _eventloop {};
   FileDescriptor _input { STDIN_FILENO };
   FileDescriptor _output { STDOUT_FILENO };
-  ByteStream _outbound { buffer_size };
-  ByteStream _inbound { buffer_size };
-  bool _outbound_shutdown { false };
-  bool _inbound_shutdown { false };
+  ByteStream _outbound { buffer_size, ByteStream::Storage::Chunked };
+  ByteStream _inbound { buffer_size, ByteStream::Storage::Chunked };
+
+  // Only wake up to read once there is room for a full read.
+  _outbound.writer().set_high_watermark( buffer_size - read_size + 1 );
+  _inbound.writer().set_high_watermark( buffer_size - read_size + 1 );
+
+  // The rules' interest: the byte streams raise a flag when a side has something to do again, and each rule
+  // lowers its own flag once it has done what it can, so that no rule polls a stream on every event.
+  bool _outbound_writable { true };
+  bool _outbound_readable { false };
+  bool _inbound_writable { true };
+  bool _inbound_readable { false };
+  _outbound.writer().on_writable( [&] { _outbound_writable = true; } );
+  _outbound.reader().on_readable( [&] { _outbound_readable = true; } );
+  _inbound.writer().on_writable( [&] { _inbound_writable = true; } );
+  _inbound.reader().on_readable( [&] { _inbound_readable = true; } );
 
   socket.set_blocking( false );
   _input.set_blocking( false );
@@ -32,15 +46,16 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::In,
     [&] {
       string data;
-      data.resize( _outbound.writer().available_capacity() );
+      data.resize( min( _outbound.writer().available_capacity(), read_size ) );
       _input.read( data );
       _outbound.writer().push( move( data ) );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
+      _outbound_writable = _outbound.writer().is_writable();
     },
     [&] {
-      return ( not _outbound.reader().has_error() ) and ( _outbound.writer().available_capacity() > 0 )
+      return _outbound_writable and ( not _outbound.reader().has_error() )
              and ( not _inbound.reader().has_error() );
     },
     [&] { _outbound.writer().close(); } );
@@ -52,16 +67,14 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        drain( _outbound.reader(), socket );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
-        _outbound_shutdown = true;
       }
+      _outbound_readable = _outbound.reader().is_readable();
     },
-    [&] {
-      return _outbound.reader().bytes_buffered() or ( _outbound.reader().is_finished() and not _outbound_shutdown );
-    },
+    [&] { return _outbound_readable; },
     [&] { _outbound.writer().close(); } );
 
   // rule 3: read from socket into inbound byte stream
@@ -71,16 +84,16 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::In,
     [&] {
       string data;
-      data.resize( _inbound.writer().available_capacity() );
+      data.resize( min( _inbound.writer().available_capacity(), read_size ) );
       socket.read( data );
       _inbound.writer().push( move( data ) );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
+      _inbound_writable = _inbound.writer().is_writable();
     },
     [&] {
-      return ( not _inbound.reader().has_error() ) and ( _inbound.writer().available_capacity() > 0 )
-             and ( not _outbound.reader().has_error() );
+      return _inbound_writable and ( not _inbound.reader().has_error() ) and ( not _outbound.reader().has_error() );
     },
     [&] { _inbound.writer().close(); } );
 
@@ -91,16 +104,14 @@ void bidirectional_stream_copy( Socket& socket )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        drain( _inbound.reader(), _output );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
-        _inbound_shutdown = true;
       }
+      _inbound_readable = _inbound.reader().is_readable();
     },
-    [&] {
-      return _inbound.reader().bytes_buffered() or ( _inbound.reader().is_finished() and not _inbound_shutdown );
-    },
+    [&] { return _inbound_readable; },
     [&] { _inbound.writer().close(); } );
 
   // loop until completion
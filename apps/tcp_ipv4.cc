@@ -32,7 +32,17 @@ static void show_usage( const char* argv0, const char* msg )
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
        << "\n\n"
 
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -M <mtu>        Offer an MSS for an MTU of <mtu> bytes          " << TCPConfig::DEFAULT_MTU << "\n"
+       << "   -m              Probe for the path MTU (RFC 4821)               (full MSS from the start)\n\n"
+
+       << "   -b              Reassemble with a bitmap (for large windows)    (ordered map)\n"
+       << "   -D              Reassemble in place, in the receive buffer      (ordered map)\n\n"
+
+       << "   -C <algo>       Congestion control: none, newreno or cubic      (newreno)\n"
+       << "   -P              Pace segments over the round-trip time          (no pacing)\n"
+       << "   -N              Coalesce small writes (Nagle's algorithm)       (no Nagle)\n"
+       << "   -K              Autocork small writes behind earlier segments   (no autocork)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
@@ -93,6 +103,56 @@ static tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const sp
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-M", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -M requires one argument." );
+      const long mtu = strtol( args[curr + 1], nullptr, 0 );
+      if ( mtu < TCPConfig::MIN_MTU or mtu > UINT16_MAX ) {
+        const string err = "ERROR: -M must be from " + to_string( TCPConfig::MIN_MTU ) + " to 65535.";
+        show_usage( args.front(), err.c_str() );
+        exit( 1 );
+      }
+      c_fsm.mtu = static_cast<uint16_t>( mtu );
+      curr += 2;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      c_fsm.mtu_probing = true;
+      curr += 1;
+
+    } else if ( strncmp( "-b", args[curr], 3 ) == 0 ) {
+      c_fsm.reassembler_engine = Reassembler::Engine::Bitmap;
+      curr += 1;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      c_fsm.reassembler_engine = Reassembler::Engine::Direct;
+      curr += 1;
+
+    } else if ( strncmp( "-C", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -C requires one argument." );
+      const string algorithm { args[curr + 1] };
+      if ( algorithm == "none" ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::None;
+      } else if ( algorithm == "newreno" ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::NewReno;
+      } else if ( algorithm == "cubic" ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::Cubic;
+      } else {
+        show_usage( args.front(), "ERROR: -C must be none, newreno or cubic." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      c_fsm.pacing = true;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nagle = true;
+      curr += 1;
+
+    } else if ( strncmp( "-K", args[curr], 3 ) == 0 ) {
+      c_fsm.autocork = true;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -1,31 +1,262 @@
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include "byte_stream.hh"
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+// Smallest ring allocated on the first push; the ring then doubles as needed, up to the stream's capacity.
+static constexpr uint64_t MIN_RING_SIZE = 4096;
+
+// A Chunked stream copies pushes shorter than this, rather than keeping each one as a chunk of its own, into
+// chunks allocated with room for this many bytes.
+static constexpr uint64_t SMALL_PUSH = 512;
+static constexpr uint64_t SMALL_CHUNK_SIZE = 4096;
+
+ByteStream::ByteStream( uint64_t capacity, Storage storage, uint64_t memory_limit )
+  : capacity_( capacity )
+  , storage_( storage )
+  , ring_limit_( storage == Storage::Spill ? max( min( capacity, memory_limit ), uint64_t { 1 } ) : capacity )
+  , high_watermark_( capacity )
+{}
+
+bool ByteStream::reader_ready() const
+{
+  return reader().is_readable() or reader().is_finished();
+}
+
+void ByteStream::notify_readable( bool was_readable )
+{
+  if ( not was_readable and on_readable_ and reader_ready() ) {
+    on_readable_();
+  }
+}
+
+void ByteStream::notify_writable( bool was_writable )
+{
+  if ( not was_writable and on_writable_ and writer().is_writable() ) {
+    on_writable_();
+  }
+}
+
+void ByteStream::reserve_ring( uint64_t len )
+{
+  if ( len <= ring_.size() ) {
+    return;
+  }
+
+  uint64_t size = max( ring_.size(), MIN_RING_SIZE );
+  while ( size < len ) {
+    size *= 2;
+  }
+  size = min( size, ring_limit_ );
+
+  // Linearize the buffered bytes at the front of the new ring.
+  const uint64_t buffered = ring_buffered();
+  const uint64_t first = min( buffered, ring_.size() - head_ );
+  string ring( size, 0 );
+  memcpy( ring.data(), ring_.data() + head_, first );
+  memcpy( ring.data() + first, ring_.data(), buffered - first );
+  ring_ = move( ring );
+  head_ = 0;
+}
+
+void ByteStream::push_ring( string_view data )
+{
+  // Bytes go to the ring while it has room, unless earlier bytes are still waiting in the spill file.
+  const uint64_t buffered = ring_buffered();
+  const uint64_t len = spilled_ == 0 ? min( static_cast<uint64_t>( data.size() ), ring_limit_ - buffered ) : 0;
+  if ( len > 0 ) {
+    reserve_ring( buffered + len );
+
+    // Copy into the free region after the tail, wrapping around to the front of the ring if needed.
+    uint64_t tail = head_ + buffered;
+    if ( tail >= ring_.size() ) {
+      tail -= ring_.size();
+    }
+    const uint64_t first = min( len, ring_.size() - tail );
+    memcpy( ring_.data() + tail, data.data(), first );
+    memcpy( ring_.data(), data.data() + first, len - first );
+    bytes_written_ += len;
+    data.remove_prefix( len );
+  }
+
+  if ( data.empty() ) {
+    return;
+  }
+
+  // Spill the rest, wrapping around to the front of the file if needed.
+  const uint64_t offset = bytes_written_ % capacity_;
+  const uint64_t first = min( static_cast<uint64_t>( data.size() ), capacity_ - offset );
+  spill_.write( offset, data.substr( 0, first ) );
+  spill_.write( 0, data.substr( first ) );
+  bytes_written_ += data.size();
+  spilled_ += data.size();
+}
+
+void ByteStream::push_small( string_view data )
+{
+  // Only a chunk the stream allocated itself may grow, and only within its allocation: slices of it may
+  // have been handed out, and they must keep pointing at the same bytes.
+  if ( chunks_.empty() or tail_shared_
+       or static_cast<string&>( chunks_.back() ).capacity() - chunks_.back().size() < data.size() ) {
+    string chunk;
+    chunk.reserve( max( static_cast<uint64_t>( data.size() ), min( SMALL_CHUNK_SIZE, capacity_ ) ) );
+    chunks_.emplace_back( move( chunk ) );
+    tail_shared_ = false;
+  }
+  static_cast<string&>( chunks_.back() ).append( data );
+  bytes_written_ += data.size();
+}
+
+void ByteStream::read_spill( uint64_t index, span<char> out ) const
+{
+  const uint64_t offset = index % capacity_;
+  const uint64_t first = min( static_cast<uint64_t>( out.size() ), capacity_ - offset );
+  spill_.read( offset, out.subspan( 0, first ) );
+  spill_.read( 0, out.subspan( first ) );
+}
+
+void ByteStream::refill_ring()
+{
+  // Refilling in small pieces would cost a system call per pop, so wait until the ring is half empty
+  // (but never let it run dry while bytes are spilled, so that peek() has something to offer).
+  const uint64_t buffered = ring_buffered();
+  if ( spilled_ == 0 or ( buffered > 0 and ring_limit_ - buffered < ring_limit_ / 2 ) ) {
+    return;
+  }
+
+  const uint64_t len = min( spilled_, ring_limit_ - buffered );
+  reserve_ring( buffered + len );
+
+  // Read into the free region after the tail, wrapping around to the front of the ring if needed.
+  uint64_t tail = head_ + buffered;
+  if ( tail >= ring_.size() ) {
+    tail -= ring_.size();
+  }
+  const uint64_t index = bytes_written_ - spilled_;
+  const uint64_t first = min( len, ring_.size() - tail );
+  read_spill( index, { ring_.data() + tail, first } );
+  read_spill( index + first, { ring_.data(), len - first } );
+
+  // The bytes read are now only in the ring; let the file give back their space.
+  const uint64_t offset = index % capacity_;
+  const uint64_t first_hole = min( len, capacity_ - offset );
+  spill_.discard( offset, first_hole );
+  spill_.discard( 0, len - first_hole );
+  spilled_ -= len;
+}
 
 void Writer::push( string data )
 {
   // Your code here.
-  for ( auto current { data.begin() }; current != data.end() && capacity_ > 0; current++ ) {
-    data_.push_back( *current );
-    capacity_--;
-    bytes_written_++;
+  if ( storage_ == Storage::Chunked and data.size() >= SMALL_PUSH ) {
+    data.resize( min( static_cast<uint64_t>( data.size() ), available_capacity() ) );
+    if ( data.capacity() > 2 * data.size() ) {
+      data = string( data ); // a copy allocates only what it holds
+    }
+    push( Buffer( move( data ) ) );
+    return;
+  }
+
+  const string_view view = string_view( data ).substr( 0, available_capacity() );
+  if ( view.empty() ) {
+    return;
   }
+
+  const bool was_readable = reader_ready();
+  if ( storage_ == Storage::Chunked ) {
+    push_small( view );
+  } else {
+    push_ring( view );
+  }
+  notify_readable( was_readable );
+}
+
+void Writer::push( Buffer data )
+{
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const bool was_readable = reader_ready();
+  if ( storage_ != Storage::Chunked ) {
+    push_ring( string_view( data ).substr( 0, len ) );
+  } else if ( len < SMALL_PUSH ) {
+    push_small( string_view( data ).substr( 0, len ) );
+  } else {
+    if ( len < data.size() ) {
+      data = data.slice( 0, len );
+    }
+    chunks_.push_back( move( data ) );
+    tail_shared_ = true;
+    bytes_written_ += len;
+  }
+  notify_readable( was_readable );
+}
+
+void Writer::place( uint64_t offset, string_view data )
+{
+  if ( storage_ != Storage::Ring ) {
+    throw runtime_error( "Writer::place() needs a stream with Ring storage" );
+  }
+  if ( offset >= available_capacity() ) {
+    return;
+  }
+  data = data.substr( 0, available_capacity() - offset );
+
+  // Allocate the whole ring now, so that it never has to move the placed bytes.
+  reserve_ring( capacity_ );
+  placed_ = true;
+
+  // Copy past the tail, wrapping around to the front of the ring if needed.
+  uint64_t pos = head_ + ring_buffered() + offset;
+  if ( pos >= ring_.size() ) {
+    pos -= ring_.size();
+  }
+  const uint64_t first = min( static_cast<uint64_t>( data.size() ), ring_.size() - pos );
+  memcpy( ring_.data() + pos, data.data(), first );
+  memcpy( ring_.data(), data.data() + first, data.size() - first );
+}
+
+void Writer::commit( uint64_t len )
+{
+  if ( storage_ != Storage::Ring ) {
+    throw runtime_error( "Writer::commit() needs a stream with Ring storage" );
+  }
+  len = min( len, available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const bool was_readable = reader_ready();
+  reserve_ring( ring_buffered() + len );
+  bytes_written_ += len;
+  notify_readable( was_readable );
 }
 
 void Writer::close()
 {
   // Your code here.
+  const bool was_readable = reader_ready();
   close_ = true;
+  notify_readable( was_readable );
 }
 
 void Writer::set_error()
 {
   // Your code here.
   error_ = true;
+
+  // Wake up both sides so they can notice.
+  if ( on_readable_ ) {
+    on_readable_();
+  }
+  if ( on_writable_ ) {
+    on_writable_();
+  }
 }
 
 bool Writer::is_closed() const
@@ -37,7 +268,7 @@ bool Writer::is_closed() const
 uint64_t Writer::available_capacity() const
 {
   // Your code here.
-  return capacity_;
+  return capacity_ - ( bytes_written_ - bytes_read_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -46,16 +277,87 @@ uint64_t Writer::bytes_pushed() const
   return bytes_written_;
 }
 
+void Writer::set_high_watermark( uint64_t n )
+{
+  const bool was_writable = is_writable();
+  high_watermark_ = max( n, uint64_t { 1 } );
+  notify_writable( was_writable );
+}
+
+bool Writer::is_writable() const
+{
+  return available_capacity() > 0 and reader().bytes_buffered() < high_watermark_;
+}
+
+void Writer::on_writable( function<void()> callback )
+{
+  on_writable_ = move( callback );
+}
+
 string_view Reader::peek() const
 {
   // Your code here.
-  return data_;
+  if ( storage_ == Storage::Chunked ) {
+    return chunks_.empty() ? string_view {} : string_view( chunks_.front() ).substr( head_ );
+  }
+
+  return { ring_.data() + head_, min( ring_buffered(), ring_.size() - head_ ) };
+}
+
+Buffer Reader::peek_chunk() const
+{
+  if ( storage_ != Storage::Chunked or chunks_.empty() ) {
+    return {};
+  }
+  return chunks_.front().slice( head_ );
+}
+
+vector<string_view> Reader::peek_regions( size_t max_regions ) const
+{
+  vector<string_view> regions;
+  if ( storage_ == Storage::Chunked ) {
+    uint64_t offset = head_;
+    for ( auto chunk = chunks_.begin(); chunk != chunks_.end() and regions.size() < max_regions; chunk++ ) {
+      regions.push_back( string_view( *chunk ).substr( offset ) );
+      offset = 0;
+    }
+    return regions;
+  }
+
+  // The ring holds at most two regions: up to the end of `ring_`, then from its front.
+  const string_view first = peek();
+  if ( first.empty() or max_regions == 0 ) {
+    return regions;
+  }
+  regions.push_back( first );
+  if ( first.size() < ring_buffered() and max_regions > 1 ) {
+    regions.emplace_back( ring_.data(), ring_buffered() - first.size() );
+  }
+  return regions;
+}
+
+void Reader::set_low_watermark( uint64_t n )
+{
+  const bool was_readable = reader_ready();
+  low_watermark_ = max( n, uint64_t { 1 } );
+  notify_readable( was_readable );
+}
+
+bool Reader::is_readable() const
+{
+  const uint64_t buffered = bytes_buffered();
+  return buffered >= min( low_watermark_, max( capacity_, uint64_t { 1 } ) ) or ( close_ and buffered > 0 );
+}
+
+void Reader::on_readable( function<void()> callback )
+{
+  on_readable_ = move( callback );
 }
 
 bool Reader::is_finished() const
 {
   // Your code here.
-  return close_ && data_.empty();
+  return close_ && bytes_written_ == bytes_read_;
 }
 
 bool Reader::has_error() const
@@ -67,19 +369,50 @@ bool Reader::has_error() const
 void Reader::pop( uint64_t len )
 {
   // Your code here.
-  uint64_t pos { len };
-  if ( len > data_.size() ) {
-    pos = data_.size();
+  len = min( len, bytes_buffered() );
+  const bool was_writable = writer().is_writable();
+
+  if ( storage_ == Storage::Chunked ) {
+    bytes_read_ += len;
+    head_ += len;
+    while ( not chunks_.empty() and head_ >= chunks_.front().size() ) {
+      head_ -= chunks_.front().size();
+      chunks_.pop_front();
+    }
+    notify_writable( was_writable );
+    return;
   }
-  data_ = data_.substr( pos );
-  capacity_ += pos;
-  bytes_read_ += pos;
+
+  // Popping past the ring skips over spilled bytes, which are never read back.
+  const uint64_t from_ring = min( len, ring_buffered() );
+  const uint64_t from_spill = len - from_ring;
+  if ( from_spill > 0 ) {
+    const uint64_t offset = ( bytes_read_ + from_ring ) % capacity_;
+    const uint64_t first_hole = min( from_spill, capacity_ - offset );
+    spill_.discard( offset, first_hole );
+    spill_.discard( 0, from_spill - first_hole );
+    spilled_ -= from_spill;
+  }
+  bytes_read_ += len;
+
+  head_ += from_ring;
+  if ( head_ >= ring_.size() ) {
+    head_ -= ring_.size();
+  }
+
+  // Keep an empty ring's free space contiguous (unless bytes were placed in it).
+  if ( ring_buffered() == 0 and not placed_ ) {
+    head_ = 0;
+  }
+
+  refill_ring();
+  notify_writable( was_writable );
 }
 
 uint64_t Reader::bytes_buffered() const
 {
   // Your code here.
-  return data_.size();
+  return bytes_written_ - bytes_read_;
 }
 
 uint64_t Reader::bytes_popped() const
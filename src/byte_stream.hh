@@ -1,27 +1,78 @@
 #pragma once
 
+#include "buffer.hh"
+#include "spill_file.hh"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <queue>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
+public:
+  // How the stream holds its buffered bytes
+  enum class Storage : uint8_t
+  {
+    Ring,    // Pushed bytes are copied into one ring buffer (the default).
+    Chunked, // Each pushed string is moved, uncopied, onto a queue of chunks. (A string with more than twice
+             // as much allocated as it holds, like a buffer resized after a short read, is copied first, so
+             // that a chunk's memory stays in proportion to its bytes. Short strings are copied onto the end
+             // of the last chunk instead, so that many tiny pushes don't cost a chunk each.)
+    Spill,   // Like Ring, but the ring stops growing at a memory limit and further bytes wait in a temporary
+             // file until there is room for them. For very large capacities.
+  };
+
+  // Default bound on the ring of a Spill stream
+  static constexpr uint64_t DEFAULT_MEMORY_LIMIT = 1 << 20;
+
 protected:
   uint64_t capacity_;
+  Storage storage_;
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::string data_ {};
+  uint64_t ring_limit_;          // the most bytes `ring_` may hold
+  std::string ring_ {};          // ring storage; grows on demand up to `ring_limit_` bytes
+  std::deque<Buffer> chunks_ {}; // chunked storage
+  uint64_t head_ { 0 };          // index of the next byte to be popped, in `ring_` or in the front chunk
+  SpillFile spill_ {};           // spill storage: stream index `i` lives at offset `i % capacity_`
+  uint64_t spilled_ { 0 };       // the last `spilled_` bytes written are in `spill_`, not in `ring_`
+  bool placed_ {};               // bytes were placed past the tail, so the ring must stay where it is
+  bool tail_shared_ {};          // the last chunk came from a push, so appending to it is not allowed
   bool close_ {};
   bool error_ {};
 
   uint64_t bytes_written_ { 0 };
   uint64_t bytes_read_ { 0 };
 
+  uint64_t low_watermark_ { 1 };          // the Reader is readable once this many bytes are buffered
+  uint64_t high_watermark_;               // the Writer is writable while fewer bytes than this are buffered
+  std::function<void()> on_readable_ {}; // called when the Reader becomes ready (or the stream fails)
+  std::function<void()> on_writable_ {}; // called when the Writer becomes writable (or the stream fails)
+
+  bool reader_ready() const;                 // Is the Reader readable, or finished?
+  void notify_readable( bool was_readable ); // Call `on_readable_` if the Reader just became ready
+  void notify_writable( bool was_writable ); // Call `on_writable_` if the Writer just became writable
+
+  void reserve_ring( uint64_t len );       // Grow the ring so it can hold `len` buffered bytes
+  void push_ring( std::string_view data ); // Copy `data` (which must fit) after the ring's tail, or spill it
+  void refill_ring();                      // Move spilled bytes into the ring, once it has room for enough
+  void push_small( std::string_view data ); // Copy `data` (which must fit) onto the end of the last chunk
+  void read_spill( uint64_t index, std::span<char> out ) const; // Read spilled bytes, from stream index `index`
+  uint64_t ring_buffered() const { return bytes_written_ - bytes_read_ - spilled_; }
+
 public:
-  explicit ByteStream( uint64_t capacity );
+  explicit ByteStream( uint64_t capacity,
+                       Storage storage = Storage::Ring,
+                       uint64_t memory_limit = DEFAULT_MEMORY_LIMIT ); // `memory_limit` applies to Spill only
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -34,6 +85,7 @@ class Writer : public ByteStream
 {
 public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
+  void push( Buffer data );      // Same, but a Chunked stream can keep the Buffer (or slice) without copying it.
 
   void close();     // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error(); // Signal that the stream suffered an error.
@@ -41,19 +93,45 @@ public:
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  // Direct placement (Ring storage only): copy `data` into the stream's storage `offset` bytes past the
+  // end of what has been pushed, where it stays invisible to the Reader until commit() covers it. Bytes
+  // beyond the available capacity are dropped. Once used, the ring is allocated at full capacity.
+  void place( uint64_t offset, std::string_view data );
+  void commit( uint64_t len ); // Push the next `len` bytes, which must have been placed already
+
+  // Like SO_SNDLOWAT: the Writer is only writable while fewer than `n` bytes are buffered (default: capacity),
+  // so a writer that waits for is_writable() wakes up to room for at least `capacity - n + 1` bytes.
+  void set_high_watermark( uint64_t n );
+  bool is_writable() const;                          // Is there room, and are we below the high watermark?
+  void on_writable( std::function<void()> callback ); // Call `callback` whenever is_writable() becomes true
 };
 
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
+  std::string_view peek() const; // Peek at the next bytes in the buffer (the largest contiguous region)
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
+  // Peek at up to `max_regions` contiguous regions, in order, without popping them. (A Spill stream
+  // only offers the bytes in memory.)
+  std::vector<std::string_view> peek_regions( size_t max_regions ) const;
+
+  // Chunked storage only: the rest of the front chunk, as a Buffer sharing the chunk's storage (empty for other
+  // storage)
+  Buffer peek_chunk() const;
+
   bool is_finished() const; // Is the stream finished (closed and fully popped)?
   bool has_error() const;   // Has the stream had an error?
 
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+
+  // Like SO_RCVLOWAT: the Reader is only readable once `n` bytes are buffered (default: 1), or once the
+  // stream is closed with bytes left over. The watermark is capped at the stream's capacity.
+  void set_low_watermark( uint64_t n );
+  bool is_readable() const;                          // Are enough bytes buffered to be worth reading?
+  void on_readable( std::function<void()> callback ); // Call `callback` whenever it becomes readable or finished
 };
 
 /*
@@ -61,3 +139,16 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * read: The same, but into a Buffer. When the bytes all lie in the front chunk of a Chunked stream, the
+ * Buffer is a slice of that chunk, holding a reference to it instead of a copy.
+ */
+void read( Reader& reader, uint64_t len, Buffer& out );
+
+/*
+ * drain: A helper function that writes as many buffered bytes as `fd` accepts, with a single
+ * writev of up to `max_regions` regions, and pops them from the Reader. Returns the bytes written.
+ */
+static constexpr size_t DRAIN_MAX_REGIONS = 64;
+size_t drain( Reader& reader, FileDescriptor& fd, size_t max_regions = DRAIN_MAX_REGIONS );
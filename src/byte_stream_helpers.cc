@@ -1,5 +1,7 @@
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
 
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 
@@ -24,6 +26,40 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+/*
+ * read: The same, but into a Buffer, sliced from the front chunk of a Chunked stream when it can be.
+ */
+void read( Reader& reader, uint64_t len, Buffer& out )
+{
+  len = std::min( len, reader.bytes_buffered() );
+  const Buffer chunk = reader.peek_chunk();
+  if ( len > 0 and chunk.size() >= len ) {
+    out = chunk.slice( 0, len );
+    reader.pop( len );
+    return;
+  }
+
+  std::string copy;
+  read( reader, len, copy );
+  out = Buffer( std::move( copy ) );
+}
+
+/*
+ * drain: A helper function that writes as many buffered bytes as `fd` accepts, with a single
+ * writev of up to `max_regions` regions, and pops them from the Reader. Returns the bytes written.
+ */
+size_t drain( Reader& reader, FileDescriptor& fd, size_t max_regions )
+{
+  const auto regions = reader.peek_regions( max_regions );
+  if ( regions.empty() ) {
+    return 0;
+  }
+
+  const size_t bytes_written = fd.write( regions );
+  reader.pop( bytes_written );
+  return bytes_written;
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,177 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return make_unique<NewReno>( mss );
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+    case Algorithm::None:
+      break;
+  }
+  return make_unique<NoCongestionControl>( mss );
+}
+
+CongestionControl::CongestionControl( uint64_t mss ) : mss_( mss ), cwnd_( INITIAL_WINDOW * mss ) {}
+
+void CongestionControl::set_mss( uint64_t mss )
+{
+  if ( cwnd_ == INITIAL_WINDOW * mss_ ) {
+    cwnd_ = INITIAL_WINDOW * mss;
+  }
+  mss_ = mss;
+}
+
+void CongestionControl::on_mss_change( uint64_t mss )
+{
+  if ( ssthresh_ != UINT64_MAX ) {
+    ssthresh_ = ssthresh_ / mss_ * mss;
+  }
+  mss_ = mss;
+  cwnd_ = max( cwnd_, mss_ );
+}
+
+void CongestionControl::slow_start( uint64_t bytes_acked )
+{
+  cwnd_ += min( bytes_acked, mss_ );
+}
+
+void CongestionControl::on_dup_ack()
+{
+  cwnd_ += mss_;
+}
+
+void CongestionControl::on_partial_ack( uint64_t bytes_acked )
+{
+  cwnd_ -= min( bytes_acked, cwnd_ );
+  if ( bytes_acked >= mss_ ) {
+    cwnd_ += mss_;
+  }
+  cwnd_ = max( cwnd_, mss_ );
+}
+
+void CongestionControl::on_recovery_end()
+{
+  cwnd_ = ssthresh_;
+}
+
+NoCongestionControl::NoCongestionControl( uint64_t mss ) : CongestionControl( mss )
+{
+  cwnd_ = UINT64_MAX;
+}
+
+void NoCongestionControl::on_ack( uint64_t /* bytes_acked */, uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+
+void NoCongestionControl::on_timeout( uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+
+void NoCongestionControl::on_fast_retransmit( uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+
+void NoCongestionControl::on_dup_ack() {}
+
+void NoCongestionControl::on_partial_ack( uint64_t /* bytes_acked */ ) {}
+
+void NoCongestionControl::on_recovery_end() {}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t /* in_flight */, uint64_t /* now_ms */ )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // Congestion avoidance: one more segment per window's worth of bytes acked.
+  bytes_acked_ += bytes_acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_timeout( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_fast_retransmit( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_ + 3 * mss_;
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t /* in_flight */, uint64_t now_ms )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // A new epoch of congestion avoidance starts from the current window, heading back toward `w_max_`.
+  const auto mss = static_cast<double>( mss_ );
+  if ( not epoch_start_.has_value() ) {
+    epoch_start_ = now_ms;
+    cwnd_segments_ = static_cast<double>( cwnd_ ) / mss;
+    w_est_ = cwnd_segments_;
+    if ( cwnd_segments_ < w_max_ ) {
+      k_ = cbrt( ( w_max_ - cwnd_segments_ ) / C );
+      origin_ = w_max_;
+    } else {
+      k_ = 0;
+      origin_ = cwnd_segments_;
+    }
+  }
+
+  const double t = static_cast<double>( now_ms - epoch_start_.value() ) / 1000;
+  const double w_cubic = origin_ + C * pow( t - k_, 3 );
+  const double segments_acked = static_cast<double>( bytes_acked ) / mss;
+
+  // Grow at least as fast as Reno would have, with the same average window.
+  static constexpr double ALPHA = 3 * ( 1 - BETA ) / ( 1 + BETA );
+  w_est_ += ALPHA * segments_acked / cwnd_segments_;
+
+  if ( w_cubic < w_est_ ) {
+    cwnd_segments_ = w_est_;
+  } else {
+    const double target = clamp( w_cubic, cwnd_segments_, 1.5 * cwnd_segments_ );
+    cwnd_segments_ += ( target - cwnd_segments_ ) / cwnd_segments_ * segments_acked;
+  }
+  cwnd_ = max( static_cast<uint64_t>( cwnd_segments_ * mss ), mss_ );
+}
+
+void Cubic::reduce( uint64_t in_flight )
+{
+  // Fast convergence: if the window did not get back to its last peak, release some bandwidth to newer flows.
+  const double cwnd_segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  w_max_ = cwnd_segments < w_max_ ? cwnd_segments * ( 1 + BETA ) / 2 : cwnd_segments;
+
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( in_flight ) * BETA ), 2 * mss_ );
+  epoch_start_.reset();
+}
+
+void Cubic::on_timeout( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  reduce( in_flight );
+  cwnd_ = mss_;
+}
+
+void Cubic::on_fast_retransmit( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  reduce( in_flight );
+  cwnd_ = ssthresh_ + 3 * mss_;
+}
+
+void Cubic::on_mss_change( uint64_t mss )
+{
+  // The last peak keeps its size in bytes, and the epoch starts over from the window in segments of the new size.
+  w_max_ = w_max_ * static_cast<double>( mss_ ) / static_cast<double>( mss );
+  epoch_start_.reset();
+  CongestionControl::on_mss_change( mss );
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// What the TCPSender consults, besides the peer's window, for how many bytes it may have in flight. The
+// sender reports the ACKs and timeouts it sees; the algorithm adjusts its congestion window (cwnd) and
+// slow-start threshold (ssthresh). Windows are in bytes, and grow in units of the maximum segment size.
+class CongestionControl
+{
+public:
+  enum class Algorithm : uint8_t
+  {
+    None,    // No congestion window: the sender is limited by the peer's window alone.
+    NewReno, // Slow start and additive increase, halving on loss (RFC 5681).
+    Cubic,   // Window growth by a cubic function of the time since the last loss, for long fat networks
+             // (RFC 9438).
+  };
+
+  // The congestion control for `algorithm`, with segments of up to `mss` bytes
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, uint64_t mss );
+
+  // Initial window, in segments (RFC 6928)
+  static constexpr uint64_t INITIAL_WINDOW = 10;
+
+  explicit CongestionControl( uint64_t mss );
+  virtual ~CongestionControl() = default;
+  CongestionControl( const CongestionControl& other ) = delete;
+  CongestionControl& operator=( const CongestionControl& other ) = delete;
+  CongestionControl( CongestionControl&& other ) = delete;
+  CongestionControl& operator=( CongestionControl&& other ) = delete;
+
+  // `bytes_acked` new bytes were acknowledged at `now_ms`, leaving `in_flight` bytes outstanding
+  virtual void on_ack( uint64_t bytes_acked, uint64_t in_flight, uint64_t now_ms ) = 0;
+
+  // The retransmission timer expired with `in_flight` bytes outstanding
+  virtual void on_timeout( uint64_t in_flight, uint64_t now_ms ) = 0;
+
+  // Duplicate ACKs signalled a loss with `in_flight` bytes outstanding. The sender retransmits the segment and
+  // enters fast recovery: the window shrinks, then is inflated by the three segments that left the network.
+  virtual void on_fast_retransmit( uint64_t in_flight, uint64_t now_ms ) = 0;
+
+  // In fast recovery (RFC 6582): a further duplicate ACK inflates the window by a segment, a partial ACK of
+  // `bytes_acked` deflates it by as much (less a segment, for the retransmission it triggers), and the ACK of
+  // everything outstanding when recovery began deflates it to ssthresh.
+  virtual void on_dup_ack();
+  virtual void on_partial_ack( uint64_t bytes_acked );
+  virtual void on_recovery_end();
+
+  // Segments are now of up to `mss` bytes. (The MSS is settled in the handshake, before the window has grown.)
+  void set_mss( uint64_t mss );
+
+  // Later in the connection, path MTU discovery found that segments of up to `mss` bytes get through. As in
+  // Linux, the window keeps its size in bytes, and ssthresh its count of segments.
+  virtual void on_mss_change( uint64_t mss );
+
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+
+  bool in_slow_start() const { return cwnd_ < ssthresh_; }
+  void slow_start( uint64_t bytes_acked ); // Grow by up to one segment per ACK
+};
+
+class NoCongestionControl : public CongestionControl
+{
+public:
+  explicit NoCongestionControl( uint64_t mss );
+  void on_ack( uint64_t bytes_acked, uint64_t in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t in_flight, uint64_t now_ms ) override;
+  void on_fast_retransmit( uint64_t in_flight, uint64_t now_ms ) override;
+  void on_dup_ack() override;
+  void on_partial_ack( uint64_t bytes_acked ) override;
+  void on_recovery_end() override;
+};
+
+class NewReno : public CongestionControl
+{
+  uint64_t bytes_acked_ { 0 }; // bytes acked in congestion avoidance since cwnd last grew
+
+public:
+  using CongestionControl::CongestionControl;
+  void on_ack( uint64_t bytes_acked, uint64_t in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t in_flight, uint64_t now_ms ) override;
+  void on_fast_retransmit( uint64_t in_flight, uint64_t now_ms ) override;
+};
+
+class Cubic : public CongestionControl
+{
+  double w_max_ { 0 };                    // cwnd (in segments) just before the last loss
+  double k_ { 0 };                        // seconds the cubic takes to grow back to `w_max_`
+  double origin_ { 0 };                   // the cubic's plateau, in segments
+  double w_est_ { 0 };                    // what Reno would have grown to (the "Reno-friendly" window)
+  double cwnd_segments_ { 0 };            // cwnd in (fractional) segments, during congestion avoidance
+  std::optional<uint64_t> epoch_start_ {}; // when the current congestion-avoidance epoch began
+
+  void reduce( uint64_t in_flight ); // On loss, remember the peak and lower ssthresh
+
+public:
+  static constexpr double C = 0.4;    // aggressiveness of the cubic
+  static constexpr double BETA = 0.7; // the window shrinks to BETA times itself on loss
+
+  using CongestionControl::CongestionControl;
+  void on_ack( uint64_t bytes_acked, uint64_t in_flight, uint64_t now_ms ) override;
+  void on_timeout( uint64_t in_flight, uint64_t now_ms ) override;
+  void on_fast_retransmit( uint64_t in_flight, uint64_t now_ms ) override;
+  void on_mss_change( uint64_t mss ) override;
+};
@@ -1,51 +1,342 @@
 #include "reassembler.hh"
-#include <sstream>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
 
 using namespace std;
 
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
 {
   // Your code here.
+  insert( first_index, Buffer( move( data ) ), is_last_substring, output );
+}
+
+void Reassembler::insert( uint64_t first_index, Buffer data, bool is_last_substring, Writer& output )
+{
   if ( is_last_substring ) {
     end_index_ = first_index + data.size();
   }
 
-  auto size = confirm_index_ + output.available_capacity();
-  data = data.substr( 0, size > first_index ? size - first_index : 0 );
+  switch ( engine_ ) {
+    case Engine::Map:
+      insert_map( first_index, move( data ), output );
+      break;
+    case Engine::Bitmap:
+      insert_bitmap( first_index, move( data ), output );
+      break;
+    case Engine::Direct:
+      insert_direct( first_index, move( data ), output );
+      break;
+  }
+  evict();
 
-  if ( !data.empty() && ( first_index + data.size() > confirm_index_ + data_.size() ) ) {
-    data_.resize( first_index + data.size(), optional<char> {} );
+  if ( end_index_.has_value() && end_index_.value() <= confirm_index_ ) {
+    output.close();
   }
+}
 
-  for ( auto current : data ) {
-    if ( first_index < confirm_index_ ) {
-      first_index++;
-      continue;
+void Reassembler::insert_map( uint64_t first_index, Buffer data, Writer& output )
+{
+  // Keep only the bytes that are new and fit within the stream's available capacity.
+  const uint64_t end_index = first_index + data.size();
+  const uint64_t last_index = min( end_index, confirm_index_ + output.available_capacity() );
+  uint64_t index = max( first_index, confirm_index_ );
+
+  // Fill each gap between the pending substrings that overlap [index, last_index) with a slice of `data`,
+  // which shares its storage. So no byte is copied here: it goes straight into the stream if it is next in
+  // line, or else into a new pending slice.
+  auto next = pending_.upper_bound( index );
+  if ( next != pending_.begin() ) {
+    const auto& [prev_index, prev_data] = *prev( next );
+    index = max( index, prev_index + prev_data.size() );
+  }
+  while ( index < last_index ) {
+    const uint64_t gap_end = next == pending_.end() ? last_index : min( last_index, next->first );
+    if ( index < gap_end ) {
+      const bool whole = index == first_index and gap_end == end_index;
+      Buffer gap = whole ? move( data ) : data.slice( index - first_index, gap_end - index );
+      if ( index == confirm_index_ ) {
+        confirm_index_ = gap_end;
+        output.push( move( gap ) );
+      } else {
+        pending_.emplace_hint( next, index, move( gap ) );
+        pending_bytes_ += gap_end - index;
+      }
     }
+    if ( next == pending_.end() ) {
+      break;
+    }
+    index = max( index, next->first + next->second.size() );
+    ++next;
+  }
+
+  // Push the pending substrings that are now next in line.
+  while ( not pending_.empty() and pending_.begin()->first == confirm_index_ ) {
+    auto node = pending_.extract( pending_.begin() );
+    confirm_index_ += node.mapped().size();
+    pending_bytes_ -= node.mapped().size();
+    output.push( move( node.mapped() ) );
+  }
+}
 
-    if ( !data_[first_index - confirm_index_].has_value() ) {
-      data_[first_index - confirm_index_] = current;
-      pedding_++;
+void Reassembler::insert_bitmap( uint64_t first_index, Buffer data, Writer& output )
+{
+  const uint64_t last_index = min( first_index + data.size(), confirm_index_ + output.available_capacity() );
+  const uint64_t index = max( first_index, confirm_index_ );
+  if ( index >= last_index ) {
+    return;
+  }
+
+  // With nothing pending, bytes that are next in line go straight to the stream.
+  if ( index == confirm_index_ and pending_bytes_ == 0 ) {
+    confirm_index_ = last_index;
+    if ( index == first_index and last_index == first_index + data.size() ) {
+      output.push( move( data ) );
+    } else {
+      output.push( data.slice( index - first_index, last_index - index ) );
     }
-    first_index++;
+    return;
   }
 
-  string buffer {};
-  auto current { data_.begin() };
-  for ( ; current != data_.end() && current->has_value(); current++ ) {
-    buffer.push_back( current->value() );
-    confirm_index_++;
-    pedding_--;
+  // Size the ring to the stream's capacity, which bounds every window.
+  if ( ring_.size() < output.available_capacity() ) {
+    resize_ring( output.available_capacity() + output.reader().bytes_buffered() );
   }
-  data_.erase( data_.begin(), current );
-  output.push( buffer );
 
-  if ( end_index_.has_value() && end_index_.value() <= confirm_index_ ) {
-    output.close();
+  // Place the bytes in the ring (wrapping around to its front if needed), and mark them present.
+  const uint64_t len = last_index - index;
+  const uint64_t pos = index % ring_.size();
+  const uint64_t first = min( len, ring_.size() - pos );
+  const string_view placed = string_view( data ).substr( index - first_index, len );
+  memcpy( ring_.data() + pos, placed.data(), first );
+  memcpy( ring_.data(), placed.data() + first, len - first );
+  pending_bytes_ += mark_present( pos, first ) + mark_present( 0, len - first );
+
+  // Push the run of bytes that are now next in line.
+  const uint64_t head = confirm_index_ % ring_.size();
+  const uint64_t run = count_present( head );
+  if ( run == 0 ) {
+    return;
+  }
+  const uint64_t run_first = min( run, ring_.size() - head );
+  string bytes;
+  bytes.reserve( run );
+  bytes.append( ring_, head, run_first );
+  bytes.append( ring_, 0, run - run_first );
+  clear_present( head, run_first );
+  clear_present( 0, run - run_first );
+  pending_bytes_ -= run;
+  confirm_index_ += run;
+  output.push( move( bytes ) );
+}
+
+void Reassembler::insert_direct( uint64_t first_index, Buffer data, Writer& output )
+{
+  const uint64_t last_index = min( first_index + data.size(), confirm_index_ + output.available_capacity() );
+  const uint64_t index = max( first_index, confirm_index_ );
+  if ( index >= last_index ) {
+    return;
+  }
+  const uint64_t len = last_index - index;
+  const string_view placed = string_view( data ).substr( index - first_index, len );
+
+  // With nothing pending, bytes that are next in line are simply pushed.
+  if ( index == confirm_index_ and pending_bytes_ == 0 ) {
+    confirm_index_ = last_index;
+    output.push( data.slice( index - first_index, len ) );
+    return;
+  }
+
+  // One bit per byte of the stream's capacity, which bounds every window.
+  if ( present_.empty() ) {
+    present_.resize( ( output.available_capacity() + output.reader().bytes_buffered() + 63 ) / 64 );
+  }
+
+  // Copy the bytes to their final place in the stream, past its write cursor, and mark them present.
+  output.place( index - confirm_index_, placed );
+  const uint64_t pos = index % bitmap_size();
+  const uint64_t first = min( len, bitmap_size() - pos );
+  pending_bytes_ += mark_present( pos, first ) + mark_present( 0, len - first );
+
+  // Filling the hole just moves the stream's write cursor over the run of bytes that are now in line.
+  const uint64_t head = confirm_index_ % bitmap_size();
+  const uint64_t run = count_present( head );
+  if ( run == 0 ) {
+    return;
+  }
+  const uint64_t run_first = min( run, bitmap_size() - head );
+  clear_present( head, run_first );
+  clear_present( 0, run - run_first );
+  pending_bytes_ -= run;
+  confirm_index_ += run;
+  output.commit( run );
+}
+
+void Reassembler::resize_ring( uint64_t size )
+{
+  size = ( size + 63 ) / 64 * 64;
+  string ring( size, 0 );
+  vector<uint64_t> present( size / 64 );
+
+  // Move the bytes that arrived to their places in the new ring (a cold path: the ring is sized once).
+  for ( uint64_t i = confirm_index_, moved = 0; moved < pending_bytes_; i++ ) {
+    const uint64_t old_pos = i % ring_.size();
+    if ( present_[old_pos / 64] & ( uint64_t { 1 } << ( old_pos % 64 ) ) ) {
+      ring[i % size] = ring_[old_pos];
+      present[i % size / 64] |= uint64_t { 1 } << ( i % size % 64 );
+      moved++;
+    }
+  }
+
+  ring_ = move( ring );
+  present_ = move( present );
+}
+
+// Bits [pos % 64, pos % 64 + n) of a word, for 0 < n <= 64 - pos % 64
+static uint64_t bit_mask( uint64_t pos, uint64_t n )
+{
+  return ( n == 64 ? ~uint64_t { 0 } : ( ( uint64_t { 1 } << n ) - 1 ) ) << ( pos % 64 );
+}
+
+uint64_t Reassembler::mark_present( uint64_t pos, uint64_t len )
+{
+  uint64_t added = 0;
+  while ( len > 0 ) {
+    const uint64_t n = min( len, 64 - pos % 64 );
+    const uint64_t mask = bit_mask( pos, n );
+    uint64_t& word = present_[pos / 64];
+    added += popcount( mask & ~word );
+    word |= mask;
+    pos += n;
+    len -= n;
+  }
+  return added;
+}
+
+void Reassembler::clear_present( uint64_t pos, uint64_t len )
+{
+  while ( len > 0 ) {
+    const uint64_t n = min( len, 64 - pos % 64 );
+    present_[pos / 64] &= ~bit_mask( pos, n );
+    pos += n;
+    len -= n;
+  }
+}
+
+uint64_t Reassembler::count_present( uint64_t pos ) const
+{
+  // Scan a word at a time, wrapping around the ring. At most `pending_bytes_` bits can be set.
+  uint64_t run = 0;
+  while ( run < pending_bytes_ ) {
+    const uint64_t ones = countr_one( present_[pos / 64] >> ( pos % 64 ) );
+    const uint64_t n = min( ones, 64 - pos % 64 );
+    run += n;
+    if ( n < 64 - pos % 64 ) {
+      break;
+    }
+    pos = ( pos + n ) % bitmap_size();
+  }
+  return min( run, pending_bytes_ );
+}
+
+void Reassembler::evict()
+{
+  if ( pending_bytes_ <= pending_limit_ ) {
+    return;
+  }
+  uint64_t excess = pending_bytes_ - pending_limit_;
+  pending_bytes_ -= excess;
+  bytes_evicted_ += excess;
+
+  if ( engine_ == Engine::Map ) {
+    while ( excess > 0 ) {
+      const auto last = prev( pending_.end() );
+      Buffer& data = last->second;
+      if ( data.size() > excess ) {
+        data = data.slice( 0, data.size() - excess );
+        break;
+      }
+      excess -= data.size();
+      pending_.erase( last );
+    }
+    return;
+  }
+
+  // Clear the highest set bits, scanning down a word at a time from the top of the window (the position
+  // just before the next expected byte's) and wrapping around the ring.
+  uint64_t pos = ( confirm_index_ + bitmap_size() - 1 ) % bitmap_size();
+  while ( excess > 0 ) {
+    uint64_t& word = present_[pos / 64];
+    uint64_t bits = word & bit_mask( pos - pos % 64, pos % 64 + 1 );
+    while ( bits != 0 and excess > 0 ) {
+      const uint64_t highest = uint64_t { 1 } << ( 63 - countl_zero( bits ) );
+      word &= ~highest;
+      bits &= ~highest;
+      excess--;
+    }
+    pos = pos < 64 ? bitmap_size() - 1 : pos - pos % 64 - 1;
+  }
+}
+
+void Reassembler::set_pending_limit( uint64_t limit )
+{
+  pending_limit_ = limit;
+  evict();
+}
+
+Reassembler::Stats Reassembler::stats() const
+{
+  Stats stats { .bytes_pending = pending_bytes_, .bytes_evicted = bytes_evicted_ };
+  uint64_t index = confirm_index_;
+  for ( const auto& [first_index, end_index] : pending_ranges() ) {
+    if ( first_index > index ) {
+      stats.holes++;
+      stats.largest_hole = max( stats.largest_hole, first_index - index );
+    }
+    index = end_index;
+  }
+  return stats;
+}
+
+vector<Reassembler::Range> Reassembler::pending_ranges() const
+{
+  vector<Range> ranges;
+  auto add = [&ranges]( uint64_t first_index, uint64_t len ) {
+    if ( not ranges.empty() and ranges.back().end_index == first_index ) {
+      ranges.back().end_index += len; // neighbouring slices may abut
+    } else {
+      ranges.push_back( { first_index, first_index + len } );
+    }
+  };
+
+  if ( engine_ == Engine::Map ) {
+    for ( const auto& [first_index, data] : pending_ ) {
+      add( first_index, data.size() );
+    }
+    return ranges;
+  }
+
+  // Walk the runs of clear and set bits from the next expected byte until every pending byte is seen.
+  uint64_t index = confirm_index_;
+  uint64_t pos = present_.empty() ? 0 : confirm_index_ % bitmap_size();
+  uint64_t seen = 0;
+  while ( seen < pending_bytes_ ) {
+    const uint64_t word = present_[pos / 64] >> ( pos % 64 );
+    const uint64_t bits_left = 64 - pos % 64;
+    const bool set = word & 1;
+    const uint64_t run = min( static_cast<uint64_t>( set ? countr_one( word ) : countr_zero( word ) ), bits_left );
+    if ( set ) {
+      add( index, run );
+      seen += run;
+    }
+    index += run;
+    pos = ( pos + run ) % bitmap_size();
   }
+  return ranges;
 }
 
 uint64_t Reassembler::bytes_pending() const
 {
-  return pedding_;
+  return pending_bytes_;
 }
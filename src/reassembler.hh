@@ -3,18 +3,71 @@
 #include "byte_stream.hh"
 
 #include <cstdint>
-#include <deque>
+#include <map>
 #include <optional>
 #include <string>
+#include <vector>
 
 class Reassembler
 {
+public:
+  // How the Reassembler holds bytes that are not yet next in line
+  enum class Engine : uint8_t
+  {
+    Map,    // An ordered map of substrings, holding only the bytes that arrived (the default).
+    Bitmap, // A ring the size of the stream's capacity, plus one bit per byte saying whether it arrived.
+            // Memory is constant per connection and inserts are branch-light, which suits large windows.
+    Direct, // Like Bitmap, but out-of-order bytes are placed straight into the stream's own storage, so there
+            // is no second buffer and no second copy. Needs a stream with Ring storage.
+  };
+
+  // A snapshot of how much the Reassembler holds, and how fragmented it is
+  struct Stats
+  {
+    uint64_t holes {};         // gaps between the next expected byte and the last pending byte
+    uint64_t largest_hole {};  // length of the longest such gap
+    uint64_t bytes_pending {}; // bytes held, waiting for the gaps before them to fill
+    uint64_t bytes_evicted {}; // bytes dropped (over the lifetime) to stay within the pending limit
+  };
+
+  // A run of pending bytes, [first_index, end_index) in stream indices
+  struct Range
+  {
+    uint64_t first_index {};
+    uint64_t end_index {};
+  };
+
+private:
+  Engine engine_;
   std::optional<uint64_t> end_index_ {};
-  std::deque<std::optional<char>> data_ {};
   uint64_t confirm_index_ { 0 };
-  uint64_t pedding_ { 0 };
+  uint64_t pending_bytes_ { 0 };
+  uint64_t pending_limit_ { UINT64_MAX };
+  uint64_t bytes_evicted_ { 0 };
+
+  // Map engine: non-overlapping slices of inserted substrings past `confirm_index_`, by first index
+  std::map<uint64_t, Buffer> pending_ {};
+
+  // Bitmap engine: byte `i` of the stream is stored at `ring_[i % ring_.size()]`, and has arrived
+  // if bit `i % ring_.size()` of `present_` is set. The ring's size is a multiple of 64.
+  // Direct engine: the same bits, but the bytes are placed in the stream (and `ring_` stays empty).
+  std::string ring_ {};
+  std::vector<uint64_t> present_ {};
+
+  uint64_t bitmap_size() const { return present_.size() * 64; }
+
+  void insert_map( uint64_t first_index, Buffer data, Writer& output );
+  void insert_bitmap( uint64_t first_index, Buffer data, Writer& output );
+  void insert_direct( uint64_t first_index, Buffer data, Writer& output );
+  void resize_ring( uint64_t size );                    // Grow the ring, keeping the bytes that arrived
+  uint64_t mark_present( uint64_t pos, uint64_t len );  // Set bits; returns how many were newly set
+  void clear_present( uint64_t pos, uint64_t len );     // Clear bits
+  uint64_t count_present( uint64_t pos ) const;         // Length of the run of set bits starting at `pos`
+  void evict();                                         // Drop the farthest pending bytes down to the limit
 
 public:
+  explicit Reassembler( Engine engine = Engine::Map ) : engine_( engine ) {}
+
   /*
    * Insert a new substring to be reassembled into a ByteStream.
    *   `first_index`: the index of the first byte of the substring
@@ -37,6 +90,21 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring, Writer& output );
 
+  // Same, but out-of-order bytes are kept as slices of `data` rather than copies, and a Chunked stream can
+  // keep them without copying at all.
+  void insert( uint64_t first_index, Buffer data, bool is_last_substring, Writer& output );
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
+
+  // Hold at most `limit` pending bytes. Past that, the bytes farthest from the next expected byte are
+  // dropped first (the sender will retransmit them). The Bitmap and Direct engines' memory is fixed
+  // when they are first used, but they honour the limit too.
+  void set_pending_limit( uint64_t limit );
+
+  // How fragmented is the pending data? (Costs a walk over the pending ranges.)
+  Stats stats() const;
+
+  // The runs of pending bytes, in order, each as long as it can be (e.g. for SACK blocks)
+  std::vector<Range> pending_ranges() const;
 };
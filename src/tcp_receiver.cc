@@ -1,5 +1,7 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+
 using namespace std;
 
 void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, Writer& inbound_stream )
@@ -12,8 +14,26 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
   if ( !zero_point_.has_value() ) {
     return;
   }
-  reassembler.insert( message.seqno.unwrap( zero_point_.value(), checkpoint_ ) + ( message.SYN ? 0 : -1 ),
-                      message.payload,
+  const uint64_t index = message.seqno.unwrap( zero_point_.value(), checkpoint_ ) + ( message.SYN ? 0 : -1 );
+
+  if ( message.timestamp.has_value() ) {
+    const uint32_t timestamp = message.timestamp.value();
+    // PAWS (RFC 7323 5): a segment stamped before the last one at the left edge is an old duplicate, which
+    // may even be from an earlier lap of the sequence space.
+    const bool stale = ts_recent_.has_value() and static_cast<int32_t>( timestamp - ts_recent_.value() ) < 0;
+    if ( stale and not message.SYN ) {
+      return;
+    }
+    // Only a segment at the left edge updates the echo, so that a duplicate ACK times the segment that was
+    // delayed or lost, not the one that drew it (RFC 7323 4.3).
+    if ( index <= checkpoint_ ) {
+      ts_recent_ = timestamp;
+    }
+  }
+
+  last_index_ = index;
+  reassembler.insert( last_index_,
+                      move( message.payload ),
                       message.FIN,
                       inbound_stream );
   checkpoint_ = inbound_stream.bytes_pushed();
@@ -21,13 +41,42 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
 
 TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream ) const
 {
+  // A scaled window is rounded down, so as never to offer more than there is room for.
+  const uint64_t window = min( inbound_stream.available_capacity(), uint64_t { UINT16_MAX } << window_shift_ );
   auto message = TCPReceiverMessage {
-    .window_size = static_cast<uint16_t>(
-      ( inbound_stream.available_capacity() > UINT16_MAX ) ? UINT16_MAX : inbound_stream.available_capacity() ),
+    .window_size = static_cast<uint16_t>( window >> window_shift_ ),
   };
 
   if ( zero_point_.has_value() ) {
     message.ackno = Wrap32::wrap( checkpoint_, zero_point_.value() ) + 1 + ( inbound_stream.is_closed() ? 1 : 0 );
   }
+  message.timestamp_echo = ts_recent_;
   return message;
 }
+
+vector<SACKBlock> TCPReceiver::sack_blocks( const Reassembler& reassembler ) const
+{
+  vector<SACKBlock> blocks;
+  if ( !zero_point_.has_value() ) {
+    return blocks;
+  }
+
+  auto ranges = reassembler.pending_ranges();
+  // The range with the most recent segment goes first (RFC 2018), then the others in order.
+  const auto latest = find_if( ranges.begin(), ranges.end(), [this]( const auto& range ) {
+    return range.first_index <= last_index_ and last_index_ < range.end_index;
+  } );
+  if ( latest != ranges.end() ) {
+    rotate( ranges.begin(), latest, latest + 1 );
+  }
+
+  for ( const auto& [first_index, end_index] : ranges ) {
+    if ( blocks.size() == TCPReceiverMessage::MAX_SACK_BLOCKS ) {
+      break;
+    }
+    // Stream indices are one less than absolute seqnos, which count the SYN.
+    blocks.push_back( { Wrap32::wrap( first_index + 1, zero_point_.value() ),
+                        Wrap32::wrap( end_index + 1, zero_point_.value() ) } );
+  }
+  return blocks;
+}
@@ -9,6 +9,9 @@ class TCPReceiver
 private:
   std::optional<Wrap32> zero_point_ {};
   uint64_t checkpoint_ {};
+  uint64_t last_index_ {};  // stream index of the most recently received payload
+  uint8_t window_shift_ {}; // the advertised window counts units of 2^window_shift_ bytes (RFC 7323)
+  std::optional<uint32_t> ts_recent_ {}; // the timestamp to echo (RFC 7323 TS.Recent)
 
 public:
   /*
@@ -17,6 +20,12 @@ public:
    */
   void receive( TCPSenderMessage message, Reassembler& reassembler, Writer& inbound_stream );
 
+  /* Scale the advertised window, once the peer has agreed to window scaling */
+  void set_window_scale( uint8_t shift ) { window_shift_ = shift; }
+
   /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
   TCPReceiverMessage send( const Writer& inbound_stream ) const;
+
+  /* SACK blocks for the bytes the Reassembler holds, the most recently received first (at most MAX_SACK_BLOCKS) */
+  std::vector<SACKBlock> sack_blocks( const Reassembler& reassembler ) const;
 };
@@ -2,16 +2,45 @@
 #include "tcp_config.hh"
 
 #include <algorithm>
+#include <iterator>
 #include <optional>
 #include <random>
 
 using namespace std;
 
+// Pace at twice the window per RTT in slow start, so that the window can still double each round trip, and a
+// little faster than the window per RTT otherwise (the gains Linux uses).
+static constexpr uint64_t SLOW_START_PACING_GAIN_PERCENT = 200;
+static constexpr uint64_t PACING_GAIN_PERCENT = 120;
+
+// The sender's clock ticks in milliseconds, so a late tick may release up to a millisecond's worth of messages.
+static constexpr uint64_t PACING_QUANTUM_US = 1000;
+
+// Duplicate ACKs that signal a lost segment (RFC 5681)
+static constexpr uint64_t DUP_ACK_THRESHOLD = 3;
+
+// Lost probes of one size before path MTU discovery gives up on it (RFC 4821 7.6.2)
+static constexpr uint64_t MAX_PROBES = 3;
+
+// The clock granularity G of RFC 6298: the RTO is at least a tick more than the smoothed RTT.
+static constexpr uint64_t CLOCK_GRANULARITY_US = 1000;
+
 /* TCPSender constructor (uses a random ISN if none given) */
-TCPSender::TCPSender( uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn )
-  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) ), initial_RTO_ms_( initial_RTO_ms )
+TCPSender::TCPSender( uint64_t initial_RTO_ms,
+                      optional<Wrap32> fixed_isn,
+                      CongestionControl::Algorithm congestion_control )
+  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , initial_RTO_ms_( initial_RTO_ms )
+  , mss_( TCPConfig::MAX_PAYLOAD_SIZE )
+  , congestion_control_( CongestionControl::make( congestion_control, mss_ ) )
 {}
 
+void TCPSender::set_mss( uint64_t mss )
+{
+  mss_ = mss;
+  congestion_control_->set_mss( mss );
+}
+
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
   return unacknowledged_ - acknowledged_;
@@ -23,23 +52,191 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return retransmissions_;
 }
 
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_control_->cwnd();
+}
+
+uint64_t TCPSender::slow_start_threshold() const
+{
+  return congestion_control_->ssthresh();
+}
+
+TCPSender::RTTEstimate TCPSender::rtt_estimate() const
+{
+  return { srtt_us_, rttvar_us_, current_RTO_ms() };
+}
+
+TCPSender::PathMTUSearch TCPSender::path_mtu_search() const
+{
+  return { mss_,
+           search_high_,
+           probe_.has_value() ? optional<uint64_t> { probe_->size } : nullopt,
+           probe_failures_ };
+}
+
+void TCPSender::set_path_mtu_discovery( uint64_t base_mss )
+{
+  search_high_ = mss_;
+  mss_ = min( base_mss, mss_ );
+  congestion_control_->set_mss( mss_ );
+}
+
+void TCPSender::set_adaptive_RTO( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+{
+  adaptive_RTO_ = true;
+  min_RTO_ms_ = min_RTO_ms;
+  max_RTO_ms_ = max( min_RTO_ms, max_RTO_ms );
+}
+
+uint64_t TCPSender::current_RTO_ms() const
+{
+  // Until the first RTT sample, the initial RTO (RFC 6298 2.1)
+  if ( not adaptive_RTO_ or not srtt_us_.has_value() ) {
+    return initial_RTO_ms_;
+  }
+  // RTO <- SRTT + max (G, K*RTTVAR), where K = 4, rounded up to the clock's milliseconds (RFC 6298 2.3)
+  const uint64_t RTO_us = srtt_us_.value() + max( CLOCK_GRANULARITY_US, 4 * rttvar_us_ );
+  return clamp( ( RTO_us + 999 ) / 1000, min_RTO_ms_, max_RTO_ms_ );
+}
+
+uint64_t TCPSender::backed_off_RTO_ms() const
+{
+  const uint64_t RTO_ms = current_RTO_ms();
+  if ( retransmissions_ >= 64 or RTO_ms > ( max_RTO_ms_ >> retransmissions_ ) ) {
+    return max( RTO_ms, max_RTO_ms_ );
+  }
+  return RTO_ms << retransmissions_;
+}
+
+void TCPSender::set_pacing( bool enabled )
+{
+  pacing_ = enabled;
+  next_send_us_ = 0;
+}
+
+uint64_t TCPSender::send_window() const
+{
+  const uint64_t cwnd = congestion_window();
+  const uint64_t in_flight = sequence_numbers_in_flight();
+  return min( windows_size_, cwnd > in_flight ? cwnd - in_flight : 0 );
+}
+
+uint64_t TCPSender::pacing_interval_us( uint64_t sequence_length ) const
+{
+  const uint64_t cwnd = congestion_window();
+  const uint64_t window = min( cwnd, peer_window_ );
+  if ( not pacing_ or not srtt_us_.has_value() or window == 0 ) {
+    return 0;
+  }
+  const uint64_t srtt_us = max( srtt_us_.value(), uint64_t { 1000 } ); // as precise as the clock gets
+  const uint64_t gain = cwnd < slow_start_threshold() ? SLOW_START_PACING_GAIN_PERCENT : PACING_GAIN_PERCENT;
+  return sequence_length * srtt_us * 100 / ( gain * window );
+}
+
+bool TCPSender::hold_back( uint64_t payload_size, const Reader& outbound_stream ) const
+{
+  // A full segment, the last bytes of a closed stream and a zero-window probe never wait.
+  if ( payload_size >= mss_ or outbound_stream.writer().is_closed() or try_send_ or flushing_ ) {
+    return false;
+  }
+  // Autocork waits for earlier messages to be sent. Without pacing, nothing waits for long, so it waits for them
+  // to be acknowledged instead, as Nagle's algorithm does.
+  const bool queued = next_send_ < messages_.size() or ( not pacing_ and sequence_numbers_in_flight() > 0 );
+  return cork_ or ( nagle_ and sequence_numbers_in_flight() > 0 ) or ( autocork_ and queued );
+}
+
+uint64_t TCPSender::probe_size() const
+{
+  // One probe at a time, and none while recovering from a loss, so that a lost probe points to the path's MTU
+  // rather than to congestion (RFC 4821 7.5).
+  if ( search_high_ <= mss_ or probe_.has_value() or recover_.has_value() or retransmissions_ > 0 or dup_acks_ > 0
+       or not sacked_.empty() ) {
+    return 0;
+  }
+  return bisect_ ? mss_ + ( search_high_ - mss_ + 1 ) / 2 : search_high_;
+}
+
+bool TCPSender::retransmitting( size_t index )
+{
+  if ( not probe_.has_value() or messages_[index].seqno != probe_->seqno ) {
+    return false;
+  }
+
+  const Outstanding probe = messages_[index];
+  vector<Outstanding> pieces;
+  for ( uint64_t offset = 0; offset < probe.message.payload.size(); offset += mss_ ) {
+    TCPSenderMessage piece = probe.message;
+    piece.payload = probe.message.payload.slice( offset, mss_ );
+    piece.FIN = false;
+    pieces.push_back( { probe.seqno + offset, move( piece ), probe.sent_ms } );
+  }
+  pieces.back().message.FIN = probe.message.FIN;
+
+  const auto at = messages_.erase( messages_.begin() + static_cast<ptrdiff_t>( index ) );
+  messages_.insert( at, pieces.begin(), pieces.end() );
+  next_send_ += pieces.size() - 1;
+  retransmit_until_ = probe.end();
+
+  if ( ++probe_failures_ == MAX_PROBES ) {
+    search_high_ = probe_->size - 1;
+    bisect_ = true;
+    probe_failures_ = 0;
+  }
+  probe_.reset();
+  return true;
+}
+
+void TCPSender::resent( const Outstanding& outstanding )
+{
+  if ( rtt_probe_.has_value() and outstanding.seqno < rtt_probe_->seqno_end
+       and rtt_probe_->seqno_end <= outstanding.end() ) {
+    rtt_probe_.reset();
+  }
+}
+
+void TCPSender::sent( const Outstanding& outstanding )
+{
+  if ( not rtt_probe_.has_value() ) {
+    rtt_probe_ = RTTProbe { outstanding.end(), now_ms_ };
+  }
+
+  const uint64_t interval = pacing_interval_us( outstanding.message.sequence_length() );
+  if ( interval > 0 ) {
+    const uint64_t now_us = now_ms_ * 1000;
+    next_send_us_ = max( next_send_us_, now_us > PACING_QUANTUM_US ? now_us - PACING_QUANTUM_US : 0 ) + interval;
+  }
+}
+
 optional<TCPSenderMessage> TCPSender::maybe_send()
 {
   // Your code here.
-  for ( const auto& msg : messages_ ) {
-    auto isn = msg.seqno.unwrap( isn_, acknowledged_ ) + msg.sequence_length() + 1;
-    if ( isn > send_ ) {
-      send_ = isn;
-      if ( !RTO_ms_.has_value() ) {
-        RTO_ms_ = optional<uint64_t> { initial_RTO_ms_ };
-      }
-      return optional<TCPSenderMessage> { msg };
+  if ( fast_retransmit_ ) {
+    fast_retransmit_ = false;
+    if ( const auto hole = next_hole() ) {
+      retransmitting( hole.value() );
+      high_rxt_ = messages_[hole.value()].end();
+      fast_retransmit_ = high_rxt_ < retransmit_until_; // the rest of a lost probe goes too
+      resent( messages_[hole.value()] );
+      return optional<TCPSenderMessage> { wire_message( messages_[hole.value()] ) };
     }
   }
 
+  if ( next_send_ < messages_.size() and next_send_us_ <= now_ms_ * 1000 ) {
+    if ( !RTO_ms_.has_value() ) {
+      RTO_ms_ = optional<uint64_t> { current_RTO_ms() };
+    }
+    messages_[next_send_].sent_ms = now_ms_;
+    sent( messages_[next_send_] );
+    return optional<TCPSenderMessage> { wire_message( messages_[next_send_++] ) };
+  }
+
   if ( expire_ ) {
     expire_ = false;
-    return optional<TCPSenderMessage> { messages_.front() };
+    fast_retransmit_ = retransmitting( 0 );
+    high_rxt_ = messages_.front().end();
+    resent( messages_.front() );
+    return optional<TCPSenderMessage> { wire_message( messages_.front() ) };
   }
   return nullopt;
 }
@@ -49,71 +246,284 @@ void TCPSender::push( Reader& outbound_stream )
   if ( try_send_ && windows_size_ == 0 ) {
     windows_size_ = 1;
   }
-  while ( windows_size_ > 0 && !is_close_ ) {
-    TCPSenderMessage message {
-      .seqno = Wrap32::wrap( unacknowledged_, isn_ ),
-    };
+  while ( !is_close_ ) {
+    uint64_t window = send_window();
+    if ( window == 0 ) {
+      break;
+    }
+    TCPSenderMessage message {};
 
     if ( try_send_ ) {
       try_msg_ = unacknowledged_;
     }
 
-    if ( unacknowledged_ == 0 && windows_size_ > 0 ) {
-      windows_size_--;
+    if ( unacknowledged_ == 0 ) {
+      window--;
       message.SYN = true;
     }
-    auto n = min( outbound_stream.bytes_buffered(), min( windows_size_, TCPConfig::MAX_PAYLOAD_SIZE ) );
-    message.payload = Buffer( string( outbound_stream.peek().substr( 0, n ) ) );
-    windows_size_ -= message.payload.size();
-    outbound_stream.pop( message.payload.size() );
+    auto n = min( outbound_stream.bytes_buffered(), min( window, mss_ ) );
+    const uint64_t probe = message.SYN ? 0 : probe_size();
+    if ( probe > 0 and outbound_stream.bytes_buffered() >= probe and window >= probe ) {
+      n = probe;
+      probe_ = MTUProbe { unacknowledged_, probe };
+    }
+    if ( not message.SYN and hold_back( n, outbound_stream ) ) {
+      break;
+    }
+    read( outbound_stream, n, message.payload ); // a slice of the stream's own storage, where it can be
+    window -= message.payload.size();
 
-    if ( !is_close_ && outbound_stream.is_finished() && windows_size_ > 0 ) {
-      windows_size_--;
+    if ( !is_close_ && outbound_stream.is_finished() && window > 0 ) {
       message.FIN = true;
       is_close_ = true;
     }
 
-    unacknowledged_ += message.sequence_length();
-
     if ( message.sequence_length() == 0 ) {
       break;
     }
 
+    windows_size_ -= message.sequence_length();
     try_send_ = false;
-    messages_.push_back( message );
+    messages_.push_back( { unacknowledged_, move( message ) } );
+    unacknowledged_ = messages_.back().end();
   }
 }
 
+void TCPSender::flush( Reader& outbound_stream )
+{
+  flushing_ = true;
+  push( outbound_stream );
+  flushing_ = false;
+}
+
 TCPSenderMessage TCPSender::send_empty_message() const
 {
   // Your code here.
-  return TCPSenderMessage {
+  return stamped( TCPSenderMessage {
     .seqno = Wrap32::wrap( unacknowledged_, isn_ ),
-  };
+  } );
+}
+
+TCPSenderMessage TCPSender::wire_message( const Outstanding& outstanding ) const
+{
+  TCPSenderMessage message = stamped( outstanding.message );
+  message.seqno = Wrap32::wrap( outstanding.seqno, isn_ );
+  return message;
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::remove_acknowledged()
+{
+  // Messages are in sequence order, so the fully acknowledged ones are at the front.
+  while ( not messages_.empty() and messages_.front().end() <= acknowledged_ ) {
+    messages_.pop_front();
+    next_send_ -= next_send_ > 0 ? 1 : 0;
+  }
+}
+
+TCPSenderMessage TCPSender::stamped( TCPSenderMessage message ) const
+{
+  if ( timestamps_ ) {
+    message.timestamp = static_cast<uint32_t>( now_ms_ );
+  }
+  return message;
+}
+
+void TCPSender::sample_rtt( uint64_t rtt_us )
+{
+  if ( not srtt_us_.has_value() ) {
+    // SRTT <- R, RTTVAR <- R/2 (RFC 6298 2.2)
+    srtt_us_ = rtt_us;
+    rttvar_us_ = rtt_us / 2;
+    return;
+  }
+  // RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - R'|, then SRTT <- 7/8 SRTT + 1/8 R' (RFC 6298 2.3)
+  const uint64_t srtt_us = srtt_us_.value();
+  const uint64_t deviation_us = srtt_us > rtt_us ? srtt_us - rtt_us : rtt_us - srtt_us;
+  rttvar_us_ = rttvar_us_ - rttvar_us_ / 4 + deviation_us / 4;
+  srtt_us_ = srtt_us - srtt_us / 8 + rtt_us / 8;
+}
+
+uint64_t TCPSender::window_of( const TCPReceiverMessage& msg ) const
+{
+  return static_cast<uint64_t>( msg.window_size ) << window_shift_;
+}
+
+void TCPSender::duplicate_ack( const TCPReceiverMessage& msg, bool with_data )
+{
+  // A duplicate ACK acknowledges nothing new while data is outstanding, carries no data, and leaves the window
+  // as it was (RFC 5681). Each one means a segment beyond a hole reached the receiver.
+  if ( with_data or next_send_ == 0 or window_of( msg ) != peer_window_ or msg.window_size == 0 ) {
+    return;
+  }
+
+  dup_acks_++;
+  if ( dup_acks_ == DUP_ACK_THRESHOLD and not recover_.has_value() ) {
+    loss_detected();
+  } else if ( dup_acks_ > DUP_ACK_THRESHOLD and recover_.has_value() ) {
+    congestion_control_->on_dup_ack();
+  }
+}
+
+void TCPSender::loss_detected()
+{
+  // A lost probe says the path's MTU is smaller than the probe, not that the path is congested (RFC 4821 7.6.2).
+  const auto hole = next_hole();
+  if ( not recover_.has_value() and probe_.has_value() and hole.has_value()
+       and messages_[hole.value()].seqno == probe_->seqno ) {
+    high_rxt_ = acknowledged_;
+    fast_retransmit_ = true;
+    return;
+  }
+
+  if ( not recover_.has_value() and acknowledged_ >= recovery_point_ ) {
+    recover_ = sent_end();
+    high_rxt_ = acknowledged_;
+    congestion_control_->on_fast_retransmit( sequence_numbers_in_flight(), now_ms_ );
+  }
+  fast_retransmit_ = true;
+}
+
+uint64_t TCPSender::sent_end() const
+{
+  if ( next_send_ == 0 ) {
+    return acknowledged_;
+  }
+  return messages_[next_send_ - 1].end();
+}
+
+void TCPSender::update_scoreboard( const vector<SACKBlock>& blocks )
+{
+  const uint64_t end_of_data = sent_end();
+  for ( const auto& [left, right] : blocks ) {
+    uint64_t first = left.unwrap( isn_, acknowledged_ );
+    uint64_t end = right.unwrap( isn_, acknowledged_ );
+    if ( first >= end or end <= acknowledged_ or end > end_of_data ) {
+      continue; // a block of old data (a D-SACK), or nonsense
+    }
+
+    // Merge with the ranges it overlaps or abuts.
+    auto it = sacked_.upper_bound( first );
+    if ( it != sacked_.begin() and prev( it )->second >= first ) {
+      --it;
+    }
+    while ( it != sacked_.end() and it->first <= end ) {
+      first = min( first, it->first );
+      end = max( end, it->second );
+      it = sacked_.erase( it );
+    }
+    sacked_.emplace( first, end );
+  }
+
+  while ( not sacked_.empty() and sacked_.begin()->first < acknowledged_ ) {
+    const uint64_t end = sacked_.begin()->second;
+    sacked_.erase( sacked_.begin() );
+    if ( end > acknowledged_ ) {
+      sacked_.emplace( acknowledged_, end );
+    }
+  }
+}
+
+bool TCPSender::sacked( uint64_t first, uint64_t end ) const
+{
+  auto it = sacked_.upper_bound( first );
+  return it != sacked_.begin() and prev( it )->second >= end;
+}
+
+uint64_t TCPSender::sacked_above( uint64_t seqno ) const
+{
+  uint64_t total = 0;
+  for ( const auto& [first, end] : sacked_ ) {
+    if ( end > seqno ) {
+      total += end - max( first, seqno );
+    }
+  }
+  return total;
+}
+
+optional<size_t> TCPSender::next_hole() const
+{
+  // Messages are in sequence order, so the search starts with the first one that ends past `from`.
+  const uint64_t from = max( acknowledged_, high_rxt_ );
+  const auto sent_end = messages_.begin() + static_cast<ptrdiff_t>( next_send_ );
+  auto it = partition_point(
+    messages_.begin(), sent_end, [from]( const Outstanding& outstanding ) { return outstanding.end() <= from; } );
+  for ( ; it != sent_end; ++it ) {
+    if ( not sacked( it->seqno, it->end() ) ) {
+      return static_cast<size_t>( it - messages_.begin() );
+    }
+  }
+  return nullopt;
+}
+
+bool TCPSender::lost( const Outstanding& outstanding ) const
+{
+  // As many bytes SACKed past it as duplicate ACKs would take to call it lost (RFC 6675 IsLost)
+  return sacked_above( outstanding.seqno ) > ( DUP_ACK_THRESHOLD - 1 ) * mss_;
+}
+
+void TCPSender::receive( const TCPReceiverMessage& msg, bool with_data )
 {
   if ( msg.ackno.has_value() ) {
     auto isn = msg.ackno.value().unwrap( isn_, acknowledged_ );
     if ( isn > acknowledged_ && isn <= unacknowledged_ ) {
+      const uint64_t bytes_acked = isn - acknowledged_ - ( acknowledged_ == 0 ? 1 : 0 ); // not counting the SYN
       acknowledged_ = max( acknowledged_, isn );
-      messages_.erase( remove_if( messages_.begin(),
-                                  messages_.end(),
-                                  [this]( const TCPSenderMessage& m ) {
-                                    return m.seqno.unwrap( isn_, acknowledged_ ) + m.sequence_length()
-                                           <= acknowledged_;
-                                  } ),
-                       messages_.end() );
-      RTO_ms_ = optional<uint64_t> { initial_RTO_ms_ };
+      dup_acks_ = 0;
+      if ( recover_.has_value() and acknowledged_ >= recover_.value() ) {
+        congestion_control_->on_recovery_end();
+        recover_.reset();
+      } else if ( recover_.has_value() ) {
+        // A partial ACK: the segment after the retransmitted one was lost too.
+        congestion_control_->on_partial_ack( bytes_acked );
+        fast_retransmit_ = true;
+      } else if ( bytes_acked > 0 ) {
+        congestion_control_->on_ack( bytes_acked, sequence_numbers_in_flight(), now_ms_ );
+      }
+      if ( timestamps_ and msg.timestamp_echo.has_value() ) {
+        // The echo times the segment that drew this ACK, even a retransmitted one (RFC 7323 4). But it can be no
+        // later than now, and no earlier than the first sending of the oldest message the ACK covers (RFC 7323
+        // 4.1, as Linux checks too); any other echo is bogus, and is no sample.
+        const uint32_t rtt_ms = static_cast<uint32_t>( now_ms_ ) - msg.timestamp_echo.value();
+        if ( rtt_ms <= now_ms_ - messages_.front().sent_ms ) {
+          sample_rtt( static_cast<uint64_t>( rtt_ms ) * 1000 );
+        }
+        rtt_probe_.reset();
+      } else if ( rtt_probe_.has_value() and rtt_probe_->seqno_end <= acknowledged_ ) {
+        sample_rtt( ( now_ms_ - rtt_probe_->sent_ms ) * 1000 );
+        rtt_probe_.reset();
+      }
+
+      remove_acknowledged();
       retransmissions_ = 0;
+      RTO_ms_ = optional<uint64_t> { current_RTO_ms() };
       if ( try_msg_.has_value() && try_msg_.value() <= isn ) {
         try_msg_ = nullopt;
       }
+    } else if ( isn == acknowledged_ ) {
+      duplicate_ack( msg, with_data );
+    }
+    update_scoreboard( msg.sack_blocks );
+
+    // An acknowledged probe got through: messages of its size become the norm.
+    const uint64_t probe_end = probe_.has_value() ? probe_->seqno + probe_->size : 0;
+    if ( probe_.has_value() and ( acknowledged_ >= probe_end or sacked( probe_->seqno, probe_end ) ) ) {
+      mss_ = probe_->size;
+      congestion_control_->on_mss_change( mss_ );
+      probe_failures_ = 0;
+      probe_.reset();
+    }
+
+    // With SACK, any ACK can show that the first hole was lost, however few duplicate ACKs arrived.
+    if ( not sacked_.empty() and not fast_retransmit_ ) {
+      const auto hole = next_hole();
+      if ( hole.has_value() and lost( messages_[hole.value()] ) ) {
+        loss_detected();
+      }
     }
   }
-  windows_size_
-    = msg.window_size < sequence_numbers_in_flight() ? 0 : msg.window_size - sequence_numbers_in_flight();
+
+  peer_window_ = window_of( msg );
+  windows_size_ = peer_window_ < sequence_numbers_in_flight() ? 0 : peer_window_ - sequence_numbers_in_flight();
   if ( msg.window_size == 0 ) {
     try_send_ = true;
   }
@@ -123,9 +533,19 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
   }
 }
 
+optional<uint64_t> TCPSender::ms_until_next_send() const
+{
+  if ( next_send_ == messages_.size() ) {
+    return nullopt;
+  }
+  const uint64_t now_us = now_ms_ * 1000;
+  return next_send_us_ > now_us ? ( next_send_us_ - now_us + 999 ) / 1000 : 0;
+}
+
 void TCPSender::tick( const size_t ms_since_last_tick )
 {
   // Your code here.
+  now_ms_ += ms_since_last_tick;
   if ( !RTO_ms_.has_value() ) {
     return;
   }
@@ -138,10 +558,17 @@ void TCPSender::tick( const size_t ms_since_last_tick )
 
   if ( sequence_numbers_in_flight() != 0 ) {
     expire_ = true;
-    auto isn = messages_.front().seqno.unwrap( isn_, acknowledged_ );
+    auto isn = messages_.front().seqno;
     if ( !try_msg_.has_value() || isn != try_msg_.value() ) {
       retransmissions_++;
+      congestion_control_->on_timeout( sequence_numbers_in_flight(), now_ms_ );
     }
-    RTO_ms_ = optional<uint64_t> { initial_RTO_ms_ << retransmissions_ };
+    rtt_probe_.reset(); // the timed message may be retransmitted
+    dup_acks_ = 0;
+    recover_.reset();
+    recovery_point_ = sent_end();
+    high_rxt_ = messages_.front().end();
+    fast_retransmit_ = false;
+    RTO_ms_ = optional<uint64_t> { backed_off_RTO_ms() };
   }
 }
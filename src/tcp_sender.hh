@@ -1,31 +1,204 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 #include <cstdint>
 #include <deque>
+#include <map>
+#include <memory>
 #include <optional>
 
 class TCPSender
 {
+public:
+  // The round-trip time estimate (RFC 6298), and the retransmission timeout it gives
+  struct RTTEstimate
+  {
+    std::optional<uint64_t> srtt_us {}; // smoothed round-trip time (empty until the first sample)
+    uint64_t rttvar_us {};              // round-trip time variation
+    uint64_t RTO_ms {};                 // retransmission timeout, before any backoff
+  };
+
+  // The search for the largest message that gets through the path (RFC 4821)
+  struct PathMTUSearch
+  {
+    uint64_t low {};                       // largest payload known to get through: the MSS in use
+    uint64_t high {};                      // largest payload that might get through (no more than `low` when done)
+    std::optional<uint64_t> probe_size {}; // payload of the probe in flight, if any
+    uint64_t probe_failures {};            // probes of the next size lost in a row
+  };
+
+private:
   Wrap32 isn_;
   uint64_t initial_RTO_ms_;
   uint64_t acknowledged_ { 0 };
   uint64_t unacknowledged_ { 0 };
-  uint64_t send_ { 0 };
   uint64_t windows_size_ { 1 };
-  std::deque<TCPSenderMessage> messages_ {};
+  uint64_t mss_; // largest payload of a message
+
+  // An unacknowledged message, at its absolute seqno (its Wrap32 seqno is only filled in on the way out)
+  struct Outstanding
+  {
+    uint64_t seqno;
+    TCPSenderMessage message;
+    uint64_t sent_ms {}; // when it was first sent
+    uint64_t end() const { return seqno + message.sequence_length(); } // absolute seqno just past it
+  };
+  std::deque<Outstanding> messages_ {}; // unacknowledged messages, in sequence order
+  size_t next_send_ { 0 };              // index in `messages_` of the first message not yet sent
+
   bool is_close_ { false };
   std::optional<uint64_t> RTO_ms_ {};
   uint64_t retransmissions_ { 0 };
   bool expire_ { false };
   bool try_send_ { false };
   std::optional<uint64_t> try_msg_ {};
+  std::unique_ptr<CongestionControl> congestion_control_;
+  uint64_t now_ms_ { 0 };      // time since the sender was constructed
+  uint64_t peer_window_ { 1 }; // the window the peer last advertised, in bytes
+  uint8_t window_shift_ { 0 }; // the peer's advertised windows count units of 2^window_shift_ bytes (RFC 7323)
+
+  // Round-trip time, sampled from one message at a time and never from a retransmitted one (Karn's rule), or
+  // with timestamps, from every ACK of new data
+  struct RTTProbe
+  {
+    uint64_t seqno_end; // absolute seqno just past the timed message
+    uint64_t sent_ms;
+  };
+  std::optional<RTTProbe> rtt_probe_ {};
+  std::optional<uint64_t> srtt_us_ {}; // smoothed round-trip time, in microseconds
+  uint64_t rttvar_us_ { 0 };           // round-trip time variation, in microseconds
+  bool timestamps_ { false };          // stamp messages, and time round trips from the echoed stamps (RFC 7323)
+
+  // Adaptive RTO: the timeout follows the RTT estimate, within these bounds, instead of the initial RTO
+  bool adaptive_RTO_ { false };
+  uint64_t min_RTO_ms_ { 0 };
+  uint64_t max_RTO_ms_ { UINT64_MAX };
+
+  // Fast retransmit and fast recovery (RFC 5681, RFC 6582), and SACK-based loss recovery (RFC 6675)
+  uint64_t dup_acks_ { 0 };                // duplicate ACKs in a row
+  std::optional<uint64_t> recover_ {};     // in fast recovery, until this absolute seqno is acknowledged
+  uint64_t recovery_point_ { 0 };          // after a timeout, no fast recovery until this is acknowledged
+  bool fast_retransmit_ { false };         // retransmit the first hole past `high_rxt_` now
+  uint64_t high_rxt_ { 0 };                // holes up to here have been retransmitted in this loss event
+  std::map<uint64_t, uint64_t> sacked_ {}; // SACK scoreboard: absolute seqnos the peer holds, first -> end
+
+  // Small writes: a message shorter than a full segment may wait for more bytes to coalesce with it.
+  bool nagle_ { false };    // ...while anything is unacknowledged
+  bool autocork_ { false }; // ...while earlier messages are still waiting to be sent (or acked, if not pacing)
+  bool cork_ { false };     // ...until uncorked
+  bool flushing_ { false }; // (but not during flush())
+
+  // Path MTU discovery (RFC 4821): messages of `mss_` bytes get through, and one probe message at a time tries a
+  // larger size, up to `search_high_`. The first probe tries the ceiling itself; after that, the search bisects.
+  struct MTUProbe
+  {
+    uint64_t seqno; // absolute seqno of the probe's first byte
+    uint64_t size;  // its payload
+  };
+  uint64_t search_high_ { 0 };           // largest payload that might get through (not searching if <= mss_)
+  bool bisect_ { false };                // a probe of the ceiling was lost, so probe halfway from here on
+  std::optional<MTUProbe> probe_ {};     // the probe in flight
+  uint64_t probe_failures_ { 0 };        // probes of the next size lost in a row
+  uint64_t retransmit_until_ { 0 };      // retransmit every message of a lost probe, up to this absolute seqno
+
+  // Pacing: new messages are released on a schedule, at a rate of the window per smoothed RTT, not as a burst.
+  bool pacing_ { false };
+  uint64_t next_send_us_ { 0 }; // when the next new message may be sent
+
+  uint64_t send_window() const;       // How many more sequence numbers may be sent (flow and congestion control)?
+  uint64_t current_RTO_ms() const;    // The retransmission timeout, before any backoff
+  uint64_t backed_off_RTO_ms() const; // The retransmission timeout, doubled for each consecutive retransmission
+
+  // How long sending `sequence_length` sequence numbers takes at the pacing rate (0 if not pacing)
+  uint64_t pacing_interval_us( uint64_t sequence_length ) const;
+
+  // Should a message of `payload_size` bytes wait for more bytes from the stream, rather than go now?
+  bool hold_back( uint64_t payload_size, const Reader& outbound_stream ) const;
+
+  // The payload of the next probe, if one is due now (0 if not)
+  uint64_t probe_size() const;
+
+  // The message at `index` is about to be retransmitted. If it is the probe, the probe was lost: it is split into
+  // messages of `mss_` bytes, each to be retransmitted, and the function returns true.
+  bool retransmitting( size_t index );
+
+  // Time the message if none is being timed, and schedule the next one
+  void sent( const Outstanding& outstanding );
+
+  // Stop timing the message if it is the one being timed: its ACK would be ambiguous (Karn's rule)
+  void resent( const Outstanding& outstanding );
+
+  // The message as it goes on the wire, with its Wrap32 seqno (and timestamp)
+  TCPSenderMessage wire_message( const Outstanding& outstanding ) const;
+
+  // Drop the fully acknowledged messages from the front of the queue (a partly acknowledged one stays whole)
+  void remove_acknowledged();
+
+  // Update the RTT estimate with a round-trip time measurement
+  void sample_rtt( uint64_t rtt_us );
+
+  // The message, stamped with the current time if using timestamps
+  TCPSenderMessage stamped( TCPSenderMessage message ) const;
+
+  // The window a message advertises, in bytes
+  uint64_t window_of( const TCPReceiverMessage& msg ) const;
+
+  // Count an ACK of nothing new, and retransmit on the third duplicate
+  void duplicate_ack( const TCPReceiverMessage& msg, bool with_data );
+
+  // A segment was lost: retransmit the first hole, entering fast recovery unless just recovering from a timeout
+  void loss_detected();
+
+  // Record the peer's SACK blocks, and forget what it has acknowledged
+  void update_scoreboard( const std::vector<SACKBlock>& blocks );
+
+  uint64_t sent_end() const;                          // Absolute seqno just past everything sent
+  bool sacked( uint64_t first, uint64_t end ) const;  // Does the peer hold all of [first, end)?
+  uint64_t sacked_above( uint64_t seqno ) const;      // How many seqnos past `seqno` does the peer hold?
+  std::optional<size_t> next_hole() const;            // Index of the first unSACKed message past `high_rxt_`
+  bool lost( const Outstanding& outstanding ) const;  // Has enough been SACKed past it to call it lost?
 
 public:
-  /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
-  TCPSender( uint64_t initial_RTO_ms, std::optional<Wrap32> fixed_isn );
+  /* Construct TCP sender with given default Retransmission Timeout, possible ISN and congestion control */
+  TCPSender( uint64_t initial_RTO_ms,
+             std::optional<Wrap32> fixed_isn,
+             CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None );
+
+  /* Pace new messages (retransmissions are never held back) */
+  void set_pacing( bool enabled );
+
+  /* Set the RTO from the measured round-trip times, within [min_RTO_ms, max_RTO_ms], instead of keeping the
+     initial RTO */
+  void set_adaptive_RTO( uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  /* Stamp messages with the time they are sent, and sample the RTT from the peer's echoes of the stamps */
+  void set_timestamps( bool enabled ) { timestamps_ = enabled; }
+
+  /* Send messages of up to `mss` bytes of payload (TCPConfig::MAX_PAYLOAD_SIZE until this is called) */
+  void set_mss( uint64_t mss );
+
+  /* Send messages of `base_mss` bytes at first, probing for larger ones up to the MSS (call after set_mss) */
+  void set_path_mtu_discovery( uint64_t base_mss );
+
+  /* Hold back a message shorter than a full segment while anything is unacknowledged (Nagle's algorithm) */
+  void set_nagle( bool enabled ) { nagle_ = enabled; }
+
+  /* Hold back a message shorter than a full segment while earlier messages have yet to be sent by pacing (or,
+     without pacing, to be acknowledged) */
+  void set_autocork( bool enabled ) { autocork_ = enabled; }
+
+  /* Hold back a message shorter than a full segment until uncorked, like TCP_CORK (the next push() after
+     uncorking sends it) */
+  void set_cork( bool enabled ) { cork_ = enabled; }
+
+  /* Push bytes from the outbound stream, sending even a short message that would otherwise be held back */
+  void flush( Reader& outbound_stream );
+
+  /* Scale the peer's advertised windows, once it has agreed to window scaling */
+  void set_window_scale( uint8_t shift ) { window_shift_ = shift; }
 
   /* Push bytes from the outbound stream */
   void push( Reader& outbound_stream );
@@ -36,13 +209,25 @@ public:
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage send_empty_message() const;
 
-  /* Receive an act on a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive an act on a TCPReceiverMessage from the peer's receiver (`with_data` if it came on a segment that
+     carried data, so that it is not a duplicate ACK) */
+  void receive( const TCPReceiverMessage& msg, bool with_data = false );
 
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called. */
   void tick( uint64_t ms_since_last_tick );
 
+  /* How many milliseconds until the next unsent message may be sent (empty if there is none) */
+  std::optional<uint64_t> ms_until_next_send() const;
+
+  /* How many milliseconds until the retransmission timer expires (empty if it is not running) */
+  std::optional<uint64_t> ms_until_timeout() const { return RTO_ms_; }
+
   /* Accessors for use in testing */
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;           // The congestion window, in bytes (UINT64_MAX if none)
+  uint64_t slow_start_threshold() const;        // The slow-start threshold, in bytes
+  RTTEstimate rtt_estimate() const;             // The RTT estimate and retransmission timeout
+  uint64_t mss() const { return mss_; }         // The largest payload of a message
+  PathMTUSearch path_mtu_search() const;        // The state of path MTU discovery
 };
@@ -3,6 +3,7 @@
 
 #include <exception>
 #include <iostream>
+#include <memory>
 
 using namespace std;
 
@@ -43,6 +44,147 @@ int main()
       all_zeroes( test );
     }
 
+    {
+      ByteStreamTestHarness test { "default-watermarks", 15 };
+      test.execute( IsReadable { false } );
+      test.execute( IsWritable { true } );
+      test.execute( Push { "a" } );
+      test.execute( IsReadable { true } );
+      test.execute( Push { "bcdefghijklmnopqrs" } );
+      test.execute( IsWritable { false } );
+      test.execute( Pop { 1 } );
+      test.execute( IsWritable { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "low-watermark", 15 };
+      test.execute( SetLowWatermark { 4 } );
+      test.execute( Push { "abc" } );
+      test.execute( IsReadable { false } );
+      test.execute( Push { "d" } );
+      test.execute( IsReadable { true } );
+      test.execute( Pop { 2 } );
+      test.execute( IsReadable { false } );
+      test.execute( SetLowWatermark { 2 } );
+      test.execute( IsReadable { true } );
+      test.execute( SetLowWatermark { 100 } ); // capped at the capacity
+      test.execute( Push { "efghijklmnopq" } );
+      test.execute( BytesBuffered { 15 } );
+      test.execute( IsReadable { true } );
+      test.execute( Pop { 14 } );
+      test.execute( IsReadable { false } );
+      test.execute( Close {} );
+      test.execute( IsReadable { true } ); // the leftovers are readable once the stream closes
+      test.execute( Pop { 1 } );
+      test.execute( IsReadable { false } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "high-watermark", 15 };
+      test.execute( SetHighWatermark { 5 } );
+      test.execute( Push { "abcd" } );
+      test.execute( IsWritable { true } );
+      test.execute( Push { "e" } );
+      test.execute( IsWritable { false } );
+      test.execute( AvailableCapacity { 10 } );
+      test.execute( Push { "fghij" } ); // pushing above the high watermark is still allowed
+      test.execute( BytesBuffered { 10 } );
+      test.execute( Pop { 5 } );
+      test.execute( IsWritable { false } );
+      test.execute( Pop { 1 } );
+      test.execute( IsWritable { true } );
+    }
+
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      ByteStreamTestHarness test { "watermarks", 15, storage };
+      auto counts = make_shared<pair<uint64_t, uint64_t>>();
+      test.execute( CountNotifications { counts } );
+      test.execute( SetLowWatermark { 3 } );
+      test.execute( SetHighWatermark { 10 } );
+      test.execute( IsReadable { false } );
+      test.execute( IsWritable { true } );
+      test.execute( Notifications { counts, 0, 0 } );
+      test.execute( Push { "ab" } );
+      test.execute( IsReadable { false } );
+      test.execute( Notifications { counts, 0, 0 } );
+      test.execute( Push { "c" } );
+      test.execute( IsReadable { true } );
+      test.execute( Notifications { counts, 1, 0 } );
+      test.execute( Push { "defghijk" } );
+      test.execute( IsWritable { false } );
+      test.execute( Notifications { counts, 1, 0 } );
+      test.execute( Pop { 1 } );
+      test.execute( IsWritable { false } );
+      test.execute( Notifications { counts, 1, 0 } );
+      test.execute( Pop { 1 } );
+      test.execute( IsWritable { true } );
+      test.execute( Notifications { counts, 1, 1 } );
+      test.execute( Pop { 8 } );
+      test.execute( IsReadable { false } );
+      test.execute( Notifications { counts, 1, 1 } );
+      test.execute( Push { "lmn" } );
+      test.execute( IsReadable { true } );
+      test.execute( Notifications { counts, 2, 1 } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "o" } );
+      test.execute( IsReadable { false } );
+      test.execute( Close {} );
+      test.execute( IsReadable { true } );
+      test.execute( Notifications { counts, 3, 1 } );
+      test.execute( SetError {} );
+      test.execute( Notifications { counts, 4, 2 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "close-notifies-an-empty-stream", 15 };
+      auto counts = make_shared<pair<uint64_t, uint64_t>>();
+      test.execute( CountNotifications { counts } );
+      test.execute( Push { "ab" } );
+      test.execute( Notifications { counts, 1, 0 } );
+      test.execute( Pop { 2 } );
+      test.execute( Close {} );
+      test.execute( IsFinished { true } );
+      test.execute( Notifications { counts, 2, 0 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "read-buffer-chunked", 15, ByteStream::Storage::Chunked };
+      test.execute( Push { "abcdef" } );
+      test.execute( Push { "ghij" } );
+      test.execute( ReadBuffer { "abc", true } );
+      test.execute( ReadBuffer { "def", true } );
+      test.execute( ReadBuffer { "ghij", true } );
+      test.execute( Push { "klm" } );
+      test.execute( Push { "nop" } );
+      test.execute( ReadBuffer { "klmn", true } ); // short pushes are copied into one chunk
+      test.execute( ReadBuffer { "op", true } );
+      test.execute( BufferEmpty { true } );
+    }
+
+    {
+      const string big( 600, 'x' );
+      ByteStreamTestHarness test { "read-buffer-chunked-big", 1000, ByteStream::Storage::Chunked };
+      test.execute( Push { big } );
+      test.execute( Push { "abc" } );
+      test.execute( Push { "def" } );
+      test.execute( ReadBuffer { big.substr( 1 ), true } );
+      test.execute( ReadBuffer { "xab", false } ); // spans two chunks
+      test.execute( ReadBuffer { "cde", true } );
+      test.execute( Push { big } );
+      test.execute( Push { "ghi" } ); // not appended to a chunk the stream was handed
+      test.execute( ReadBuffer { "f" + big.substr( 1 ), false } );
+      test.execute( ReadBuffer { "xghi", false } );
+      test.execute( BufferEmpty { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "read-buffer-ring", 15 };
+      test.execute( Push { "abcdef" } );
+      test.execute( ReadBuffer { "abc", false } );
+      test.execute( ReadAll { "def" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << "\n";
     return EXIT_FAILURE;
@@ -97,6 +97,53 @@ int main()
       test.execute( BytesBuffered { 1 } );
     }
 
+    {
+      ByteStreamTestHarness test { "spill-and-pop-past-memory", 8, ByteStream::Storage::Spill, 3 };
+
+      test.execute( Push { "abcdefghij" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( BytesBuffered { 8 } );
+      test.execute( PeekOnce { "abc" } );
+      test.execute( Peek { "abcdefgh" } );
+      test.execute( Pop { 5 } );
+      test.execute( BytesBuffered { 3 } );
+      test.execute( PeekOnce { "fgh" } );
+      test.execute( Push { "ijklm" } );
+      test.execute( BytesPushed { 13 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "fghijklm" } );
+      test.execute( Pop { 7 } );
+      test.execute( BytesPopped { 12 } );
+      test.execute( PeekOnce { "m" } );
+      test.execute( Close {} );
+      test.execute( Pop { 1 } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "place-then-commit", 8 };
+
+      test.execute( Push { "ab" } );
+      test.execute( Place { 3, "fgh" } );
+      test.execute( BytesPushed { 2 } );
+      test.execute( Peek { "ab" } );
+      test.execute( Place { 0, "cde" } );
+      test.execute( Pop { 2 } ); // an empty ring must keep the placed bytes where they are
+      test.execute( Commit { 6 } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( Peek { "cdefgh" } );
+      test.execute( Pop { 4 } );
+      test.execute( Place { 1, "jklmno" } ); // wraps around the ring; "o" is past the available capacity
+      test.execute( Push { "i" } );
+      test.execute( AvailableCapacity { 5 } );
+      test.execute( Commit { 9 } );
+      test.execute( BytesPushed { 14 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "ghijklmn" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
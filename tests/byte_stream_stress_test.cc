@@ -5,9 +5,11 @@
 
 using namespace std;
 
-void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void stress_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                  const ByteStream::Storage storage,
+                  const uint64_t memory_limit = ByteStream::DEFAULT_MEMORY_LIMIT )
 {
   default_random_engine rd { random_seed };
 
@@ -21,7 +23,9 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
   }();
 
   ByteStreamTestHarness bs { "stress test input=" + to_string( input_len ) + ", capacity=" + to_string( capacity ),
-                             capacity };
+                             capacity,
+                             storage,
+                             memory_limit };
 
   size_t expected_bytes_pushed {};
   size_t expected_bytes_popped {};
@@ -56,6 +60,12 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     }
 
     bs.execute( PeekOnce { data.substr( expected_bytes_popped, peek_size ) } );
+    for ( const size_t max_regions : { 1, 2, 64 } ) {
+      bs.execute( PeekRegions {
+        data.substr( expected_bytes_popped, expected_bytes_pushed - expected_bytes_popped ),
+        max_regions,
+        storage != ByteStream::Storage::Spill } );
+    }
 
     uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
     const size_t amount_to_pop = bytes_to_pop_dist( rd );
@@ -72,10 +82,21 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
 
 void program_body()
 {
-  stress_test( 19, 3, 10110 );
-  stress_test( 18, 17, 12345 );
-  stress_test( 1111, 17, 98765 );
-  stress_test( 4097, 4096, 11101 );
+  for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+    stress_test( 19, 3, 10110, storage );
+    stress_test( 18, 17, 12345, storage );
+    stress_test( 1111, 17, 98765, storage );
+    stress_test( 4097, 4096, 11101, storage );
+    stress_test( 100000, 65000, 24680, storage );
+  }
+
+  for ( const uint64_t memory_limit : { 1, 2, 16 } ) {
+    stress_test( 19, 3, 10110, ByteStream::Storage::Spill, memory_limit );
+    stress_test( 18, 17, 12345, ByteStream::Storage::Spill, memory_limit );
+    stress_test( 1111, 17, 98765, ByteStream::Storage::Spill, memory_limit );
+  }
+  stress_test( 4097, 4096, 11101, ByteStream::Storage::Spill, 1000 );
+  stress_test( 100000, 65000, 24680, ByteStream::Storage::Spill, 4096 );
 }
 
 int main()
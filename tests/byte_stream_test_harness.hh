@@ -4,7 +4,9 @@
 #include "common.hh"
 
 #include <concepts>
+#include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -16,10 +18,27 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Ring,
+                         uint64_t memory_limit = ByteStream::DEFAULT_MEMORY_LIMIT )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + storage_description( storage, memory_limit ),
+                   ByteStream { capacity, storage, memory_limit } )
   {}
 
+  static std::string storage_description( ByteStream::Storage storage, uint64_t memory_limit )
+  {
+    switch ( storage ) {
+      case ByteStream::Storage::Chunked:
+        return ", chunked";
+      case ByteStream::Storage::Spill:
+        return ", spilling beyond " + std::to_string( memory_limit ) + " bytes";
+      default:
+        return "";
+    }
+  }
+
   size_t peek_size() { return object().reader().peek().size(); }
 };
 
@@ -34,6 +53,28 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct Place : public Action<ByteStream>
+{
+  uint64_t offset_;
+  std::string data_;
+
+  Place( uint64_t offset, std::string data ) : offset_( offset ), data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "place \"" + Printer::prettify( data_ ) + "\" at offset " + std::to_string( offset_ );
+  }
+  void execute( ByteStream& bs ) const override { bs.writer().place( offset_, data_ ); }
+};
+
+struct Commit : public Action<ByteStream>
+{
+  uint64_t len_;
+
+  explicit Commit( uint64_t len ) : len_( len ) {}
+  std::string description() const override { return "commit( " + std::to_string( len_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().commit( len_ ); }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -55,6 +96,40 @@ struct Pop : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.reader().pop( len_ ); }
 };
 
+struct SetLowWatermark : public Action<ByteStream>
+{
+  uint64_t n_;
+
+  explicit SetLowWatermark( uint64_t n ) : n_( n ) {}
+  std::string description() const override { return "set_low_watermark( " + std::to_string( n_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.reader().set_low_watermark( n_ ); }
+};
+
+struct SetHighWatermark : public Action<ByteStream>
+{
+  uint64_t n_;
+
+  explicit SetHighWatermark( uint64_t n ) : n_( n ) {}
+  std::string description() const override { return "set_high_watermark( " + std::to_string( n_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().set_high_watermark( n_ ); }
+};
+
+// Count the on_readable() and on_writable() callbacks in `counts` (first readable, then writable)
+struct CountNotifications : public Action<ByteStream>
+{
+  std::shared_ptr<std::pair<uint64_t, uint64_t>> counts_;
+
+  explicit CountNotifications( std::shared_ptr<std::pair<uint64_t, uint64_t>> counts )
+    : counts_( move( counts ) )
+  {}
+  std::string description() const override { return "count readable/writable notifications"; }
+  void execute( ByteStream& bs ) const override
+  {
+    bs.reader().on_readable( [counts = counts_] { counts->first++; } );
+    bs.writer().on_writable( [counts = counts_] { counts->second++; } );
+  }
+};
+
 /* expectations */
 
 struct Peek : public Expectation<ByteStream>
@@ -107,6 +182,46 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekRegions : public Expectation<ByteStream>
+{
+  std::string output_;
+  size_t max_regions_;
+  bool complete_; // must fewer than `max_regions` regions cover all of `output_`? (not for Spill streams)
+
+  PeekRegions( std::string output, size_t max_regions, bool complete = true )
+    : output_( move( output ) ), max_regions_( max_regions ), complete_( complete )
+  {}
+
+  std::string description() const override
+  {
+    return "peek_regions( " + std::to_string( max_regions_ ) + " ) gives a prefix of \""
+           + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const auto regions = bs.reader().peek_regions( max_regions_ );
+    if ( regions.size() > max_regions_ ) {
+      throw ExpectationViolation { "Reader::peek_regions() returned " + std::to_string( regions.size() )
+                                   + " regions" };
+    }
+
+    std::string got;
+    for ( const auto region : regions ) {
+      if ( region.empty() ) {
+        throw ExpectationViolation { "Reader::peek_regions() returned an empty region" };
+      }
+      got += region;
+    }
+
+    const bool incomplete = complete_ and regions.size() < max_regions_ and got != output_;
+    if ( got != output_.substr( 0, got.size() ) or incomplete ) {
+      throw ExpectationViolation { "Expected regions to hold \"" + Printer::prettify( output_ ) + "\", "
+                                   + "but found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
@@ -128,6 +243,44 @@ struct HasError : public ExpectBool<ByteStream>
   bool value( ByteStream& bs ) const override { return bs.reader().has_error(); }
 };
 
+struct IsReadable : public ExpectBool<ByteStream>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "is_readable"; }
+  bool value( ByteStream& bs ) const override { return bs.reader().is_readable(); }
+};
+
+struct IsWritable : public ExpectBool<ByteStream>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "is_writable"; }
+  bool value( ByteStream& bs ) const override { return bs.writer().is_writable(); }
+};
+
+struct Notifications : public Expectation<ByteStream>
+{
+  std::shared_ptr<std::pair<uint64_t, uint64_t>> counts_;
+  std::pair<uint64_t, uint64_t> expected_;
+
+  Notifications( std::shared_ptr<std::pair<uint64_t, uint64_t>> counts, uint64_t readable, uint64_t writable )
+    : counts_( move( counts ) ), expected_( readable, writable )
+  {}
+
+  std::string description() const override
+  {
+    return "notified readable " + std::to_string( expected_.first ) + " times and writable "
+           + std::to_string( expected_.second ) + " times";
+  }
+
+  void execute( ByteStream& /* bs */ ) const override
+  {
+    if ( *counts_ != expected_ ) {
+      throw ExpectationViolation { "Expected " + description() + ", but found " + std::to_string( counts_->first )
+                                   + " and " + std::to_string( counts_->second ) };
+    }
+  }
+};
+
 struct BytesBuffered : public ExpectNumber<ByteStream, uint64_t>
 {
   using ExpectNumber::ExpectNumber;
@@ -163,6 +316,36 @@ struct BytesPopped : public ExpectNumber<ByteStream, uint64_t>
   size_t value( ByteStream& bs ) const override { return bs.reader().bytes_popped(); }
 };
 
+// Read `output.size()` bytes into a Buffer, which should (or should not) share the stream's storage
+struct ReadBuffer : public Expectation<ByteStream>
+{
+  std::string output_;
+  bool shared_;
+
+  ReadBuffer( std::string output, bool shared ) : output_( move( output ) ), shared_( shared ) {}
+
+  std::string description() const override
+  {
+    return "reading \"" + Printer::prettify( output_ ) + "\" into a Buffer that "
+           + ( shared_ ? "shares" : "does not share" ) + " the stream's storage";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const char* front = bs.reader().peek().data();
+    Buffer got;
+    read( bs.reader(), output_.size(), got );
+    if ( std::string_view( got ) != output_ ) {
+      throw ExpectationViolation { "Expected to read \"" + Printer::prettify( output_ ) + "\", but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+    if ( ( std::string_view( got ).data() == front ) != shared_ ) {
+      throw ExpectationViolation { shared_ ? "The Buffer should have been a slice of the stream's storage"
+                                           : "The Buffer should have been a copy" };
+    }
+  }
+};
+
 struct ReadAll : public Expectation<ByteStream>
 {
   std::string output_;
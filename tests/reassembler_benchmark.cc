@@ -0,0 +1,340 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Sweep the Reassembler engines over adversarial arrival patterns and window sizes, and print one row of
+// results per case, as CSV (the default) or as JSON (with --json), for tracking regressions over time.
+//
+// Each segment's string is built just before it is inserted, the way a TCPReceiver gets a freshly parsed
+// payload, so the timings and allocation counts include that (one allocation per segment of more than 15
+// bytes). Peak memory is the most heap the run held at once: stream, Reassembler and in-flight payloads.
+
+// Count heap allocations and live heap bytes, by replacing the global operator new and delete. (GCC cannot tell
+// that this operator delete's free() matches this operator new's malloc().)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static size_t allocations = 0;
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+void* operator new( size_t size )
+{
+  void* ptr = malloc( max( size, size_t { 1 } ) ); // NOLINT(*-no-malloc, *-owning-memory)
+  if ( ptr == nullptr ) {
+    throw bad_alloc();
+  }
+  allocations++;
+  live_bytes += malloc_usable_size( ptr );
+  peak_bytes = max( peak_bytes, live_bytes );
+  return ptr;
+}
+
+void* operator new[]( size_t size )
+{
+  return operator new( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  if ( ptr != nullptr ) {
+    live_bytes -= malloc_usable_size( ptr );
+    free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+  }
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+  operator delete( ptr );
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+  operator delete( ptr );
+}
+
+void operator delete[]( void* ptr, size_t /* size */ ) noexcept
+{
+  operator delete( ptr );
+}
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+struct Segment
+{
+  uint64_t first_index;
+  uint64_t length;
+  bool is_last;
+};
+
+using Plan = vector<Segment>;
+
+// Most inserts in one case, which bounds the input of the 1-byte pattern
+constexpr size_t MAX_SEGMENTS = 1 << 20;
+
+// The segments of [begin, end), in order
+vector<Segment> split( uint64_t begin, uint64_t end, uint64_t segment_len, uint64_t input_len )
+{
+  vector<Segment> segments;
+  for ( uint64_t i = begin; i < end; i += segment_len ) {
+    const uint64_t len = min( segment_len, end - i );
+    segments.push_back( { i, len, i + len == input_len } );
+  }
+  return segments;
+}
+
+// Lay out the input window by window (each `capacity` bytes), ordering each window's segments with `order`.
+Plan by_window( uint64_t input_len,
+                uint64_t capacity,
+                uint64_t segment_len,
+                const function<void( vector<Segment>& )>& order )
+{
+  Plan plan;
+  for ( uint64_t window = 0; window < input_len; window += capacity ) {
+    auto segments = split( window, min( window + capacity, input_len ), segment_len, input_len );
+    order( segments );
+    plan.insert( plan.end(), segments.begin(), segments.end() );
+  }
+  return plan;
+}
+
+struct Pattern
+{
+  string name;
+  uint64_t segment_len;
+  function<Plan( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& rd )> plan;
+};
+
+vector<Pattern> patterns()
+{
+  return {
+    { "reverse",
+      1460,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& ) {
+        // The whole window is pending until its first segment arrives.
+        return by_window( input_len, capacity, segment_len, []( auto& s ) { reverse( s.begin(), s.end() ); } );
+      } },
+
+    { "random",
+      1460,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& rd ) {
+        return by_window( input_len, capacity, segment_len, [&]( auto& s ) { shuffle( s.begin(), s.end(), rd ); } );
+      } },
+
+    { "tiny",
+      1,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& rd ) {
+        // 1-byte segments in random order: as fragmented as the pending data can get.
+        return by_window( input_len, capacity, segment_len, [&]( auto& s ) { shuffle( s.begin(), s.end(), rd ); } );
+      } },
+
+    { "holes",
+      1460,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& ) {
+        // The last segment of each window leaves a hole of nearly its capacity. The next segments fill it from
+        // its far side, except the first, so that nearly the whole window is pending when the first arrives.
+        return by_window( input_len, capacity, segment_len, []( auto& s ) {
+          if ( s.size() > 1 ) {
+            rotate( s.begin(), s.end() - 1, s.end() );
+            rotate( s.begin() + 1, s.begin() + 2, s.end() );
+          }
+        } );
+      } },
+
+    { "duplicates",
+      1460,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& rd ) {
+        // Every segment arrives three times, and once more straddling its successor, in random order.
+        return by_window( input_len, capacity, segment_len, [&]( auto& s ) {
+          const size_t n = s.size();
+          for ( size_t i = 0; i < n; i++ ) {
+            s.push_back( s[i] );
+            s.push_back( s[i] );
+            if ( i + 1 < n ) {
+              const uint64_t first = s[i].first_index + s[i].length / 2;
+              const uint64_t len = min( segment_len, s[i + 1].first_index + s[i + 1].length - first );
+              s.push_back( { first, len, first + len == input_len } );
+            }
+          }
+          shuffle( s.begin(), s.end(), rd );
+        } );
+      } },
+
+    { "last_substring",
+      1460,
+      []( uint64_t input_len, uint64_t capacity, uint64_t segment_len, default_random_engine& ) {
+        // The last segment arrives first (usually beyond the window, so only its end is learned), then an empty
+        // last substring, then each window back to front, and finally the last segment once more.
+        Plan plan;
+        const uint64_t last_len = ( input_len - 1 ) % segment_len + 1;
+        const Segment last { input_len - last_len, last_len, true };
+        plan.push_back( last );
+        plan.push_back( { input_len, 0, true } );
+        auto rest
+          = by_window( input_len, capacity, segment_len, []( auto& s ) { reverse( s.begin(), s.end() ); } );
+        plan.insert( plan.end(), rest.begin(), rest.end() );
+        plan.push_back( last );
+        return plan;
+      } },
+  };
+}
+
+string_view engine_name( Reassembler::Engine engine )
+{
+  switch ( engine ) {
+    case Reassembler::Engine::Map:
+      return "map";
+    case Reassembler::Engine::Bitmap:
+      return "bitmap";
+    case Reassembler::Engine::Direct:
+      return "direct";
+  }
+  return "unknown";
+}
+
+struct Result
+{
+  string_view pattern;
+  string_view engine;
+  uint64_t capacity;
+  uint64_t segment_len;
+  uint64_t bytes;
+  uint64_t inserts;
+  double seconds;
+  uint64_t peak_memory;
+  size_t allocations;
+};
+
+Result run( const Pattern& pattern, Reassembler::Engine engine, uint64_t capacity, const string& data )
+{
+  default_random_engine rd { capacity };
+  const uint64_t input_len = min( static_cast<uint64_t>( data.size() ), MAX_SEGMENTS * pattern.segment_len );
+  const Plan plan = pattern.plan( input_len, capacity, pattern.segment_len, rd );
+
+  ByteStream stream { capacity };
+  Reassembler reassembler { engine };
+  bool matches = true;
+
+  const size_t live_before = live_bytes;
+  const size_t allocations_before = allocations;
+  peak_bytes = live_bytes;
+
+  const auto start_time = steady_clock::now();
+  for ( const auto& [first_index, length, is_last] : plan ) {
+    reassembler.insert( first_index, data.substr( first_index, length ), is_last, stream.writer() );
+
+    while ( stream.reader().bytes_buffered() ) {
+      const string_view peeked = stream.reader().peek();
+      matches &= peeked == string_view( data ).substr( stream.reader().bytes_popped(), peeked.size() );
+      stream.reader().pop( peeked.size() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not matches or stream.reader().bytes_popped() != input_len ) {
+    throw runtime_error( "Mismatch between data written and read with pattern " + pattern.name );
+  }
+  if ( not stream.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream with pattern " + pattern.name );
+  }
+
+  return { pattern.name,
+           engine_name( engine ),
+           capacity,
+           pattern.segment_len,
+           input_len,
+           plan.size(),
+           duration_cast<duration<double>>( stop_time - start_time ).count(),
+           peak_bytes - live_before,
+           allocations - allocations_before };
+}
+
+void print( const Result& r, bool json, bool first )
+{
+  const double bytes_per_second = static_cast<double>( r.bytes ) / r.seconds;
+  const double allocations_per_insert = static_cast<double>( r.allocations ) / static_cast<double>( r.inserts );
+
+  if ( not json ) {
+    if ( first ) {
+      cout << "pattern,engine,capacity,segment_len,bytes,inserts,seconds,bytes_per_second,peak_memory_bytes,"
+              "allocations_per_insert\n";
+    }
+    cout << r.pattern << "," << r.engine << "," << r.capacity << "," << r.segment_len << "," << r.bytes << ","
+         << r.inserts << "," << fixed << setprecision( 6 ) << r.seconds << "," << setprecision( 0 )
+         << bytes_per_second << "," << r.peak_memory << "," << setprecision( 3 ) << allocations_per_insert
+         << "\n";
+    return;
+  }
+
+  cout << ( first ? "[\n" : ",\n" ) << "  { \"pattern\": \"" << r.pattern << "\", \"engine\": \"" << r.engine
+       << "\", \"capacity\": " << r.capacity << ", \"segment_len\": " << r.segment_len
+       << ", \"bytes\": " << r.bytes << ", \"inserts\": " << r.inserts << ", \"seconds\": " << fixed
+       << setprecision( 6 ) << r.seconds << ", \"bytes_per_second\": " << setprecision( 0 ) << bytes_per_second
+       << ", \"peak_memory_bytes\": " << r.peak_memory << ", \"allocations_per_insert\": " << setprecision( 3 )
+       << allocations_per_insert << " }";
+}
+
+} // namespace
+
+void program_body( bool json )
+{
+  // 1 KiB to 16 MiB windows, each fed at least 8 MiB (or four windows' worth)
+  const vector<uint64_t> capacities { 1 << 10, 1 << 14, 1 << 18, 1 << 22, 1 << 24 };
+  const uint64_t max_input_len = max( uint64_t { 1 } << 23, 4 * capacities.back() );
+
+  const string data = [&] {
+    default_random_engine rd { 1374 };
+    string ret( max_input_len, 0 );
+    generate( ret.begin(), ret.end(), [&] { return static_cast<char>( rd() ); } );
+    return ret;
+  }();
+
+  bool first = true;
+  for ( const auto& pattern : patterns() ) {
+    for ( const uint64_t capacity : capacities ) {
+      const string input = data.substr( 0, max( uint64_t { 1 } << 23, 4 * capacity ) );
+      for ( const auto engine :
+            { Reassembler::Engine::Map, Reassembler::Engine::Bitmap, Reassembler::Engine::Direct } ) {
+        print( run( pattern, engine, capacity, input ), json, first );
+        first = false;
+      }
+    }
+  }
+  if ( json ) {
+    cout << "\n]\n";
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  try {
+    if ( argc > 2 or ( argc == 2 and string_view( argv[1] ) != "--json" ) ) {
+      cerr << "Usage: " << argv[0] << " [--json]\n";
+      return EXIT_FAILURE;
+    }
+    program_body( argc == 2 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t NREPS = 8;
+static constexpr size_t NINSERTS = 256;
+
+// Insert random (overlapping, duplicate, out-of-window) substrings into each Reassembler engine, and check it
+// against a model that tracks each byte separately. A Chunked stream gets Buffers, so it holds their slices.
+static void random_inserts( Reassembler::Engine engine,
+                            ByteStream::Storage storage,
+                            size_t capacity,
+                            size_t input_len,
+                            size_t pending_limit,
+                            default_random_engine& rd )
+{
+  ReassemblerTestHarness sr { "random inserts, input=" + to_string( input_len ), capacity, engine, storage };
+  sr.execute( SetPendingLimit { pending_limit } );
+
+  string d( input_len, 0 );
+  generate( d.begin(), d.end(), [&] { return rd(); } );
+
+  vector<bool> arrived( input_len );
+  size_t pushed = 0;
+  size_t popped = 0;
+  size_t pending = 0;
+  size_t evicted = 0;
+
+  auto insert = [&]( size_t first_index, size_t len ) {
+    sr.execute( Insert { d.substr( first_index, len ), first_index }
+                  .is_last( first_index + len == input_len )
+                  .as_buffer( storage == ByteStream::Storage::Chunked ) );
+
+    for ( size_t j = max( first_index, pushed ); j < min( first_index + len, popped + capacity ); ++j ) {
+      pending += arrived[j] ? 0 : 1;
+      arrived[j] = true;
+    }
+    while ( pushed < input_len and arrived[pushed] ) {
+      ++pushed;
+      --pending;
+    }
+    const size_t window_end = min( input_len, popped + capacity );
+    for ( size_t j = window_end; pending > pending_limit; --j ) {
+      if ( j - 1 >= pushed and arrived[j - 1] ) {
+        arrived[j - 1] = false;
+        --pending;
+        ++evicted;
+      }
+    }
+
+    size_t holes = 0;
+    size_t largest_hole = 0;
+    for ( size_t j = pushed, gap = 0; j < window_end; ++j ) {
+      if ( not arrived[j] ) {
+        ++gap;
+      } else if ( gap > 0 ) {
+        ++holes;
+        largest_hole = max( largest_hole, gap );
+        gap = 0;
+      }
+    }
+
+    sr.execute( BytesPushed { pushed } );
+    sr.execute( BytesPending { pending } );
+    sr.execute( BytesEvicted { evicted } );
+    sr.execute( Holes { holes } );
+    sr.execute( LargestHole { largest_hole } );
+    sr.execute( Peek { d.substr( popped, pushed - popped ) } );
+  };
+
+  for ( size_t i = 0; i < NINSERTS and popped < input_len; ++i ) {
+    // Aim near the window: a little before it, inside it, or a little past it.
+    const size_t first_index = min( input_len - 1, pushed - min( pushed, rd() % 8 ) + rd() % ( capacity + 8 ) );
+    insert( first_index, min( input_len - first_index, static_cast<size_t>( rd() % ( capacity / 2 + 2 ) ) ) );
+
+    const size_t to_pop = rd() % ( pushed - popped + 1 );
+    sr.execute( Pop { to_pop } );
+    popped += to_pop;
+  }
+
+  // Fill in whatever is still missing, in order.
+  while ( popped < input_len ) {
+    insert( pushed, min( capacity - ( pushed - popped ), input_len - pushed ) );
+    sr.execute( Pop { pushed - popped } );
+    popped = pushed;
+  }
+
+  sr.execute( BytesPending { 0 } );
+  sr.execute( IsFinished { true } );
+}
+
+// The pending limit drops the bytes farthest from the next expected byte first.
+static void eviction( Reassembler::Engine engine )
+{
+  ReassemblerTestHarness sr { "eviction", 100, engine };
+  sr.execute( SetPendingLimit { 10 } );
+
+  sr.execute( Insert { "abcde", 10 } );
+  sr.execute( BytesPending { 5 } );
+  sr.execute( Holes { 1 } );
+  sr.execute( LargestHole { 10 } );
+
+  sr.execute( Insert { "fghij", 20 } );
+  sr.execute( BytesPending { 10 } );
+  sr.execute( Holes { 2 } );
+  sr.execute( BytesEvicted { 0 } );
+
+  sr.execute( Insert { "xyz", 40 } );
+  sr.execute( BytesPending { 10 } );
+  sr.execute( BytesEvicted { 3 } );
+  sr.execute( Holes { 2 } );
+
+  sr.execute( Insert { "klm", 5 } );
+  sr.execute( BytesPending { 10 } );
+  sr.execute( BytesEvicted { 6 } );
+  sr.execute( Holes { 3 } );
+  sr.execute( LargestHole { 5 } );
+
+  sr.execute( Insert { "01234", 0 } );
+  sr.execute( BytesPushed { 8 } );
+  sr.execute( BytesPending { 7 } );
+  sr.execute( Holes { 2 } );
+  sr.execute( LargestHole { 5 } );
+
+  sr.execute( Insert { "89", 8 } );
+  sr.execute( Insert { "fghij", 20 } );
+  sr.execute( BytesPushed { 15 } );
+  sr.execute( BytesPending { 5 } );
+  sr.execute( Holes { 1 } );
+  sr.execute( LargestHole { 5 } );
+  sr.execute( SetPendingLimit { 1 } );
+  sr.execute( BytesPending { 1 } );
+  sr.execute( BytesEvicted { 10 } );
+  sr.execute( Peek { "01234klm89abcde" } );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    for ( const auto engine :
+          { Reassembler::Engine::Map, Reassembler::Engine::Bitmap, Reassembler::Engine::Direct } ) {
+      for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+        if ( engine == Reassembler::Engine::Direct and storage != ByteStream::Storage::Ring ) {
+          continue; // the Direct engine places bytes in the stream's ring
+        }
+        for ( unsigned rep_no = 0; rep_no < NREPS; ++rep_no ) {
+          for ( const size_t capacity : { 1, 7, 64, 100, 1000 } ) {
+            // Every other run holds at most a quarter of the window, so the Reassembler evicts.
+            const size_t pending_limit = rep_no % 2 ? capacity / 4 : UINT64_MAX;
+            random_inserts( engine, storage, capacity, 1 + rd() % ( 8 * capacity ), pending_limit, rd );
+          }
+        }
+      }
+      eviction( engine );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
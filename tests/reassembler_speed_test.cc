@@ -9,6 +9,7 @@
 #include <queue>
 #include <random>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -83,9 +84,92 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   }
 }
 
+// Deliver each window of segments back to front, so the whole window is pending until its first segment arrives.
+void window_speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                        const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                        const size_t segment_len, // NOLINT(bugprone-easily-swappable-parameters)
+                        const size_t random_seed,
+                        const Reassembler::Engine engine )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  // Split the data into segments before writing, with an occasional duplicate
+  vector<tuple<uint64_t, string, bool>> split_data;
+  for ( size_t window = 0; window < data.size(); window += capacity ) {
+    const size_t window_end = min( window + capacity, data.size() );
+    for ( size_t i = window_end - ( window_end - window - 1 ) % segment_len - 1;; i -= segment_len ) {
+      split_data.emplace_back( i, data.substr( i, segment_len ), i + segment_len >= data.size() );
+      if ( rd() % 8 == 0 ) {
+        split_data.push_back( split_data.back() );
+      }
+      if ( i == window ) {
+        break;
+      }
+    }
+  }
+
+  ByteStream stream { capacity };
+  Reassembler reassembler { engine };
+
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  for ( auto& [first_index, segment, is_last] : split_data ) {
+    reassembler.insert( first_index, move( segment ), is_last, stream.writer() );
+
+    while ( stream.reader().bytes_buffered() ) {
+      output_data += stream.reader().peek();
+      stream.reader().pop( output_data.size() - stream.reader().bytes_popped() );
+    }
+  }
+
+  const auto stop_time = steady_clock::now();
+
+  if ( not stream.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream when finished" );
+  }
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto gigabits_per_second = 8 * static_cast<double>( input_len ) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << ( engine == Reassembler::Engine::Bitmap ? "Bitmap " : "" )
+       << ( engine == Reassembler::Engine::Direct ? "Direct " : "" )
+       << "Reassembler with a reversed window of capacity=" << capacity << ", segment_len=" << segment_len
+       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             Reassembler (large window) throughput: " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
 void program_body()
 {
   speed_test( 10000, 1500, 1370 );
+  for ( const auto engine :
+        { Reassembler::Engine::Map, Reassembler::Engine::Bitmap, Reassembler::Engine::Direct } ) {
+    window_speed_test( 1e7, 65536, 1460, 1371, engine );
+    window_speed_test( 1e7, 1048576, 1460, 1372, engine );
+    window_speed_test( 1e7, 1048576, 16, 1373, engine );
+  }
 }
 
 int main()
@@ -28,10 +28,16 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          Reassembler::Engine engine = Reassembler::Engine::Map,
+                          ByteStream::Storage storage = ByteStream::Storage::Ring )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { ByteStream { capacity }, Reassembler {} } )
+                   "capacity=" + std::to_string( capacity )
+                     + ( engine == Reassembler::Engine::Bitmap ? ", bitmap" : "" )
+                     + ( engine == Reassembler::Engine::Direct ? ", direct" : "" )
+                     + ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ),
+                   { ByteStream { capacity, storage }, Reassembler { engine } } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -50,11 +56,42 @@ struct BytesPending : public ExpectNumber<StreamAndReassembler, uint64_t>
   uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_pending(); }
 };
 
+struct Holes : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().holes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.stats().holes; }
+};
+
+struct LargestHole : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().largest_hole"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.stats().largest_hole; }
+};
+
+struct BytesEvicted : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().bytes_evicted"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.stats().bytes_evicted; }
+};
+
+struct SetPendingLimit : public Action<StreamAndReassembler>
+{
+  uint64_t limit_;
+
+  explicit SetPendingLimit( uint64_t limit ) : limit_( limit ) {}
+  std::string description() const override { return "set_pending_limit( " + std::to_string( limit_ ) + " )"; }
+  void execute( StreamAndReassembler& sr ) const override { sr.second.set_pending_limit( limit_ ); }
+};
+
 struct Insert : public Action<StreamAndReassembler>
 {
   std::string data_;
   uint64_t first_index_;
   bool is_last_substring_ {};
+  bool as_buffer_ {};
 
   Insert( std::string data, uint64_t first_index ) : data_( move( data ) ), first_index_( first_index ) {}
 
@@ -64,10 +101,18 @@ struct Insert : public Action<StreamAndReassembler>
     return *this;
   }
 
+  // Insert the data as a Buffer
+  Insert& as_buffer( bool status = true )
+  {
+    as_buffer_ = status;
+    return *this;
+  }
+
   std::string description() const override
   {
     std::ostringstream ss;
-    ss << "insert \"" << Printer::prettify( data_ ) << "\" @ index " << first_index_;
+    ss << "insert " << ( as_buffer_ ? "Buffer " : "" ) << "\"" << Printer::prettify( data_ ) << "\" @ index "
+       << first_index_;
     if ( is_last_substring_ ) {
       ss << " [last substring]";
     }
@@ -76,6 +121,10 @@ struct Insert : public Action<StreamAndReassembler>
 
   void execute( StreamAndReassembler& sr ) const override
   {
-    sr.second.insert( first_index_, data_, is_last_substring_, sr.first.writer() );
+    if ( as_buffer_ ) {
+      sr.second.insert( first_index_, Buffer { data_ }, is_last_substring_, sr.first.writer() );
+    } else {
+      sr.second.insert( first_index_, data_, is_last_substring_, sr.first.writer() );
+    }
   }
 };
@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -56,6 +57,16 @@ struct ExpectWindow : public ExpectNumber<ReceiverSet, uint16_t>
   uint16_t value( ReceiverSet& rs ) const override { return rs.second.send( rs.first.first.writer() ).window_size; }
 };
 
+struct ExpectTimestampEcho : public ExpectNumber<ReceiverSet, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp_echo"; }
+  std::optional<uint32_t> value( ReceiverSet& rs ) const override
+  {
+    return rs.second.send( rs.first.first.writer() ).timestamp_echo;
+  }
+};
+
 struct ExpectAckno : public ExpectNumber<ReceiverSet, std::optional<Wrap32>>
 {
   using ExpectNumber::ExpectNumber;
@@ -94,6 +105,40 @@ struct ExpectAcknoBetween : public Expectation<ReceiverSet>
   }
 };
 
+// The SACK blocks, as absolute sequence numbers [left, right)
+struct ExpectSACKBlocks : public Expectation<ReceiverSet>
+{
+  Wrap32 isn_;
+  std::vector<std::pair<uint64_t, uint64_t>> blocks_;
+
+  ExpectSACKBlocks( Wrap32 isn, std::vector<std::pair<uint64_t, uint64_t>> blocks )
+    : isn_( isn ), blocks_( std::move( blocks ) )
+  {}
+
+  static std::string describe( const std::vector<std::pair<uint64_t, uint64_t>>& blocks )
+  {
+    std::ostringstream ss;
+    for ( const auto& [left, right] : blocks ) {
+      ss << " [" << left << ", " << right << ")";
+    }
+    return blocks.empty() ? " none" : ss.str();
+  }
+
+  std::string description() const override { return "SACK blocks:" + describe( blocks_ ); }
+
+  void execute( ReceiverSet& rs ) const override
+  {
+    std::vector<std::pair<uint64_t, uint64_t>> actual;
+    for ( const auto& [left, right] : rs.second.sack_blocks( rs.first.second ) ) {
+      actual.emplace_back( left.unwrap( isn_, 0 ), right.unwrap( isn_, 0 ) );
+    }
+    if ( actual != blocks_ ) {
+      throw ExpectationViolation( "The TCPReceiver should have had SACK blocks" + describe( blocks_ )
+                                  + ", but instead it had" + describe( actual ) + "." );
+    }
+  }
+};
+
 struct HasAckno : public ExpectBool<ReceiverSet>
 {
   using ExpectBool::ExpectBool;
@@ -104,6 +149,15 @@ struct HasAckno : public ExpectBool<ReceiverSet>
   }
 };
 
+struct SetWindowScale : public Action<ReceiverSet>
+{
+  uint8_t shift_;
+
+  explicit SetWindowScale( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "set_window_scale( " + std::to_string( shift_ ) + " )"; }
+  void execute( ReceiverSet& rs ) const override { rs.second.set_window_scale( shift_ ); }
+};
+
 struct SegmentArrives : public Action<ReceiverSet>
 {
   TCPSenderMessage msg_ {};
@@ -135,6 +189,12 @@ struct SegmentArrives : public Action<ReceiverSet>
     return *this;
   }
 
+  SegmentArrives& with_timestamp( uint32_t timestamp )
+  {
+    msg_.timestamp = timestamp;
+    return *this;
+  }
+
   SegmentArrives& without_ackno()
   {
     ackno_expected_ = HasAckno { false };
@@ -161,6 +221,9 @@ struct SegmentArrives : public Action<ReceiverSet>
     if ( msg_.FIN ) {
       ss << " +FIN";
     }
+    if ( msg_.timestamp.has_value() ) {
+      ss << " TSval=" << msg_.timestamp.value();
+    }
     ss << ")";
 
     if ( ackno_expected_.value_ ) {
@@ -0,0 +1,64 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks cover the bytes past the hole", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 5, 9 } } } );
+
+      // The most recent block goes first.
+      test.execute( SegmentArrives {}.with_seqno( isn + 13 ).with_data( "mnop" ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 13, 17 }, { 5, 9 } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "fg" ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 5, 9 }, { 13, 17 } } } );
+
+      // Blocks that come to abut are merged, and filling the hole leaves none.
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ijkl" ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 5, 17 } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 17 } } );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "At most MAX_SACK_BLOCKS blocks, always including the most recent", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      for ( uint32_t i = 1; i <= 5; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 4 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 20, 21 }, { 4, 5 }, { 8, 9 }, { 12, 13 } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 16 ).with_data( "y" ) );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 16, 17 }, { 4, 5 }, { 8, 9 }, { 12, 13 } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "The FIN is not part of a SACK block", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_fin() );
+      test.execute( ExpectSACKBlocks { Wrap32 { isn }, { { 3, 5 } } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
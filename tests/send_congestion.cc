@@ -0,0 +1,176 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+// Connect, then push `len` bytes of data; the sender starts with an initial window of ten segments.
+static void connect_and_push( TCPSenderTestHarness& test, Wrap32 isn, size_t len )
+{
+  connect( test, isn, WIN );
+  test.execute( ExpectCongestionWindow { 10 * MSS } );
+  test.execute( ExpectSlowStartThreshold { UINT64_MAX } );
+  test.execute( Push( string( len, 'x' ) ) );
+}
+
+static void expect_segments( TCPSenderTestHarness& test, size_t n )
+{
+  for ( size_t i = 0; i < n; i++ ) {
+    test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+// Slow start grows the window by a segment per ACK, and a timeout shrinks it to one segment. Returns with
+// eight segments in flight, the first of them just retransmitted.
+static void slow_start_then_timeout( TCPSenderTestHarness& test, Wrap32 isn, uint64_t rto )
+{
+  connect_and_push( test, isn, 20 * MSS );
+  expect_segments( test, 10 );
+  test.execute( ExpectSeqnosInFlight { 10 * MSS } );
+
+  test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+  test.execute( ExpectCongestionWindow { 11 * MSS } );
+  expect_segments( test, 2 );
+
+  // A cumulative ACK still grows the window by one segment only.
+  test.execute( AckReceived { isn + 1 + 12 * MSS }.with_win( WIN ) );
+  test.execute( ExpectCongestionWindow { 12 * MSS } );
+  expect_segments( test, 8 );
+
+  test.execute( Tick { rto - 1 } );
+  test.execute( ExpectNoSegment {} );
+  test.execute( Tick { 1 } );
+  test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 12 * MSS ) );
+  test.execute( ExpectNoSegment {} );
+  test.execute( ExpectConsecutiveRetransmissions { 1 } );
+  test.execute( ExpectCongestionWindow { MSS } );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without congestion control, the window is the receiver's", cfg };
+      connect( test, isn, WIN );
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( Push( string( 20 * MSS, 'x' ) ) );
+      expect_segments( test, 20 );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "NewReno: the receiver's window still applies", cfg, CongestionControl::Algorithm::NewReno };
+      connect( test, isn, 3 * MSS );
+      test.execute( Push( string( 20 * MSS, 'x' ) ) );
+      expect_segments( test, 3 );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "NewReno: slow start, timeout, congestion avoidance", cfg, CongestionControl::Algorithm::NewReno };
+      slow_start_then_timeout( test, isn, cfg.rt_timeout );
+      test.execute( ExpectSlowStartThreshold { 4 * MSS } );
+
+      // Slow start again, up to ssthresh...
+      uint64_t acked = 13 * MSS;
+      for ( uint64_t cwnd = 2 * MSS; cwnd <= 4 * MSS; cwnd += MSS, acked += MSS ) {
+        test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+        test.execute( ExpectCongestionWindow { cwnd } );
+      }
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // ... then one more segment per window of bytes acknowledged.
+      for ( int i = 0; i < 3; i++, acked += MSS ) {
+        test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+        test.execute( ExpectCongestionWindow { 4 * MSS } );
+      }
+      test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 5 * MSS } );
+      test.execute( AckReceived { isn + 1 + acked + MSS }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 5 * MSS } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "NewReno: ssthresh is at least two segments after a timeout", cfg, CongestionControl::Algorithm::NewReno };
+      connect_and_push( test, isn, MSS );
+      expect_segments( test, 1 );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { MSS } );
+      test.execute( ExpectSlowStartThreshold { 2 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "CUBIC: slow start, timeout, then back toward the last peak", cfg, CongestionControl::Algorithm::Cubic };
+      slow_start_then_timeout( test, isn, cfg.rt_timeout );
+      test.execute( ExpectSlowStartThreshold { 5600 } ); // 0.7 times the 8000 bytes in flight
+
+      uint64_t acked = 13 * MSS;
+      for ( uint64_t cwnd = 2 * MSS; cwnd <= 6 * MSS; cwnd += MSS, acked += MSS ) {
+        test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+        test.execute( ExpectCongestionWindow { cwnd } );
+      }
+
+      // The cubic starts at its trough, so it grows no faster than Reno would: by 3(1-0.7)/(1+0.7) segment
+      // per window of segments acknowledged.
+      test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 6088 } );
+      acked += MSS;
+      test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 6175 } );
+      acked += MSS;
+      test.execute( AckReceived { isn + 1 + acked }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 6260 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+
+      // Long after the cubic passed the last peak (of 12 segments), the window grows by half a segment per
+      // segment acknowledged, the most it may grow in one round trip.
+      test.execute( Tick { 10000 } );
+      test.execute( Push( string( MSS, 'x' ) ) );
+      expect_segments( test, 1 );
+      test.execute( AckReceived { isn + 1 + acked + MSS }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 6760 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
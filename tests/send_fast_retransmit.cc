@@ -0,0 +1,132 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+// Connect, send five segments, and acknowledge the first: the second is the one lost.
+static void send_five( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  connect( test, isn, WIN );
+  test.execute( Push( string( 5 * MSS, 'x' ) ) );
+  for ( uint64_t i = 0; i < 5; i++ ) {
+    test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ).with_seqno( isn + 1 + i * MSS ) );
+  }
+  test.execute( ExpectNoSegment {} );
+  test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+  test.execute( ExpectNoSegment {} );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The third duplicate ACK retransmits the first outstanding segment", cfg };
+      send_five( test, isn );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // Further duplicates do not retransmit it again.
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 5 * MSS }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "ACKs with data or a new window are not duplicates", cfg };
+      send_five( test, isn );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ).with_data() );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN - 1 ) );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN - 1 ).with_data() );
+      test.execute( ExpectNoSegment {} );
+
+      // A new ACK starts the count over.
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN - 1 ) );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN - 1 ) );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN - 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN - 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 2 * MSS ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "NewReno: fast recovery", cfg, CongestionControl::Algorithm::NewReno };
+      send_five( test, isn );
+      test.execute( ExpectCongestionWindow { 11 * MSS } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+
+      // Half the 4 segments in flight, inflated by the 3 that left the network, then one more per duplicate.
+      test.execute( ExpectSlowStartThreshold { 2 * MSS } );
+      test.execute( ExpectCongestionWindow { 5 * MSS } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 6 * MSS } );
+
+      // A partial ACK retransmits the next hole, and deflates the window by the bytes it acknowledged.
+      test.execute( AckReceived { isn + 1 + 3 * MSS }.with_win( WIN ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 3 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 5 * MSS } );
+
+      // Recovery ends with the ACK of everything outstanding when it began.
+      test.execute( AckReceived { isn + 1 + 5 * MSS }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 2 * MSS } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "CUBIC: fast recovery", cfg, CongestionControl::Algorithm::Cubic };
+      send_five( test, isn );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+      test.execute( ExpectSlowStartThreshold { 2800 } ); // 0.7 times the 4000 bytes in flight
+      test.execute( ExpectCongestionWindow { 2800 + 3 * MSS } );
+      test.execute( AckReceived { isn + 1 + 5 * MSS }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 2800 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
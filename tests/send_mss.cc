@@ -0,0 +1,62 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint16_t WIN = 60000;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "The MSS sets the size of segments and of the initial window", cfg, CongestionControl::Algorithm::NewReno };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( SetMSS { 1460 } );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 14600 } );
+      test.execute( Push( string( 3000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ).with_seqno( isn + 2921 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // The window grows by a segment of the new size.
+      test.execute( AckReceived { isn + 1461 }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 16060 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "A small MSS splits a write into many segments", cfg };
+      test.execute( SetMSS { 536 } );
+      connect( test, isn, WIN );
+      test.execute( Push( string( 1200, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 128 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t BASE = 1000;
+static constexpr uint64_t CEILING = 1460;
+static constexpr uint16_t WIN = 60000;
+
+// Search from BASE up to CEILING, and connect.
+static void probe_and_connect( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  test.execute( SetMSS { CEILING } );
+  test.execute( SetPathMTUDiscovery { BASE } );
+  test.execute( ExpectMSS { BASE } );
+  test.execute( ExpectMTUSearchHigh { CEILING } );
+  connect( test, isn, WIN );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "A probe that gets through raises the MSS", cfg };
+      probe_and_connect( test, isn );
+      test.execute( Push( string( CEILING + 2 * BASE, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectMTUProbe { CEILING } );
+
+      test.execute( AckReceived { isn + 1 + CEILING }.with_win( WIN ) );
+      test.execute( ExpectMTUProbe { nullopt } );
+      test.execute( ExpectMSS { CEILING } );
+      test.execute( Push( string( 2 * CEILING, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ) );
+      test.execute( ExpectMTUProbe { nullopt } ); // the search is over
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "Congestion control counts in segments of the new size", cfg, CongestionControl::Algorithm::NewReno };
+      probe_and_connect( test, isn );
+      test.execute( ExpectCongestionWindow { 10 * BASE } );
+      test.execute( Push( string( CEILING + 2 * BASE, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+
+      // Slow start grows the window by a segment of the old size for the probe's ACK, which keeps its size in
+      // bytes when the MSS changes...
+      test.execute( AckReceived { isn + 1 + CEILING }.with_win( WIN ) );
+      test.execute( ExpectMSS { CEILING } );
+      test.execute( ExpectCongestionWindow { 11 * BASE } );
+
+      // ... then by segments of the new size.
+      test.execute( AckReceived { isn + 1 + CEILING + 2 * BASE }.with_win( WIN ) );
+      test.execute( ExpectCongestionWindow { 11 * BASE + CEILING } );
+
+      // A timeout leaves one segment of the new size.
+      test.execute( Push( string( CEILING, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ) );
+      test.execute( ExpectCongestionWindow { CEILING } );
+      test.execute( ExpectSlowStartThreshold { 2 * CEILING } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "A lost probe is resent in pieces; the window stays", cfg, CongestionControl::Algorithm::NewReno };
+      probe_and_connect( test, isn );
+      test.execute( ExpectCongestionWindow { 10 * BASE } );
+      test.execute( Push( string( CEILING + 3 * BASE, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING ).with_seqno( isn + 1 ) );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( BASE ) );
+      }
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( BASE ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING - BASE ).with_seqno( isn + 1 + BASE ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 10 * BASE } );
+      test.execute( ExpectMSS { BASE } );
+      test.execute( ExpectMTUProbeFailures { 1 } );
+
+      test.execute( AckReceived { isn + 1 + CEILING + 3 * BASE }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "After three lost probes of a size, the search bisects", cfg };
+      probe_and_connect( test, isn );
+      uint64_t acked = 1;
+      for ( uint64_t failures = 1; failures <= 3; failures++ ) {
+        // The probe times out, and goes again in pieces.
+        test.execute( Push( string( CEILING, 'x' ) ) );
+        test.execute( ExpectMessage {}.with_payload_size( CEILING ).with_seqno( isn + acked ) );
+        test.execute( Tick { cfg.rt_timeout } );
+        test.execute( ExpectMessage {}.with_payload_size( BASE ).with_seqno( isn + acked ) );
+        test.execute( ExpectMessage {}.with_payload_size( CEILING - BASE ).with_seqno( isn + acked + BASE ) );
+        test.execute( ExpectNoSegment {} );
+        acked += CEILING;
+        test.execute( AckReceived { isn + acked }.with_win( WIN ) );
+        test.execute( ExpectMTUProbeFailures { failures % 3 } );
+      }
+      test.execute( ExpectMTUSearchHigh { CEILING - 1 } );
+
+      test.execute( Push( string( CEILING, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1230 ).with_seqno( isn + acked ) );
+      test.execute( ExpectMessage {}.with_payload_size( CEILING - 1230 ) );
+      test.execute( AckReceived { isn + acked + CEILING }.with_win( WIN ) );
+      test.execute( ExpectMSS { 1230 } );
+      test.execute( ExpectMTUProbe { nullopt } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 10000;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without Nagle, each small write is a segment", cfg };
+      connect( test, isn, WIN, 10 );
+      test.execute( Push( "a" ) );
+      test.execute( ExpectMessage {}.with_data( "a" ).with_seqno( isn + 1 ) );
+      test.execute( Push( "b" ) );
+      test.execute( ExpectMessage {}.with_data( "b" ).with_seqno( isn + 2 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Nagle: small writes wait for the ACK of what is in flight", cfg };
+      test.execute( SetNagle {} );
+      connect( test, isn, WIN, 10 );
+
+      // With nothing in flight, a small write goes at once.
+      test.execute( Push( "a" ) );
+      test.execute( ExpectMessage {}.with_data( "a" ).with_seqno( isn + 1 ) );
+      test.execute( Push( "b" ) );
+      test.execute( Push( "cd" ) );
+      test.execute( ExpectNoSegment {} );
+
+      // The ACK releases everything written meanwhile, as one segment.
+      test.execute( AckReceived { isn + 2 }.with_win( WIN ) );
+      test.execute( ExpectMessage {}.with_data( "bcd" ).with_seqno( isn + 2 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // A full segment does not wait, but the short rest of the write does.
+      test.execute( Push( string( MSS + 5, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 5 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 3 + MSS } );
+
+      // Closing the stream releases its last bytes with the FIN.
+      test.execute( Close {} );
+      test.execute( ExpectMessage {}.with_payload_size( 5 ).with_fin( true ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Autocork: small writes wait behind messages not yet sent", cfg };
+      test.execute( SetAutocork {} );
+      test.execute( SetPacing {} );
+      connect( test, isn, WIN, 12 );
+
+      // 10000 bytes per 12 ms, at a gain of 1.2: a segment per millisecond, after a millisecond's worth of credit.
+      test.execute( Push( string( 3 * MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push( "ab" ) );
+      test.execute( Push( "cd" ) );
+      test.execute( ExpectSeqnosInFlight { 3 * MSS } );
+
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( Push( "ef" ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abcdef" ).with_seqno( isn + 1 + 3 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Autocork without pacing: small writes wait while anything is in flight", cfg };
+      test.execute( SetAutocork {} );
+      connect( test, isn, WIN, 12 );
+      test.execute( Push( "ab" ) );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push( "cd" ) );
+      test.execute( Push( "ef" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 3 }.with_win( WIN ) );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_data( "cdef" ).with_seqno( isn + 3 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Cork: small writes wait until flushed or uncorked", cfg };
+      test.execute( SetCork {} );
+      connect( test, isn, WIN, 10 );
+
+      // Even with nothing in flight, a small write waits.
+      test.execute( Push( "ab" ) );
+      test.execute( Push( "c" ) );
+      test.execute( ExpectNoSegment {} );
+
+      // A full segment goes, but the short rest of the write waits.
+      test.execute( Push( string( MSS + 1, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Flushing sends the rest, and the stream stays corked.
+      test.execute( Flush {} );
+      test.execute( ExpectMessage {}.with_data( "xxxx" ).with_seqno( isn + 1 + MSS ) );
+      test.execute( Push( "de" ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Uncorking lets the next push send what waits.
+      test.execute( SetCork { false } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_data( "de" ).with_seqno( isn + 5 + MSS ) );
+      test.execute( Push( "f" ) );
+      test.execute( ExpectMessage {}.with_data( "f" ).with_seqno( isn + 7 + MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
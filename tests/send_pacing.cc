@@ -0,0 +1,127 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+static void expect_segments( TCPSenderTestHarness& test, size_t n )
+{
+  for ( size_t i = 0; i < n; i++ ) {
+    test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The smoothed RTT skips retransmitted messages", cfg };
+      connect( test, isn, 60000, 8 );
+
+      test.execute( Push( string( MSS, 'x' ) ) );
+      expect_segments( test, 1 );
+      test.execute( Tick { 16 } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( 60000 ) );
+      test.execute( ExpectSmoothedRTT { 9000 } ); // 7/8 of 8 ms plus 1/8 of 16 ms
+
+      test.execute( Push( string( MSS, 'x' ) ) );
+      expect_segments( test, 1 );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + MSS ) );
+      test.execute( Tick { 4 } );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( 60000 ) );
+      test.execute( ExpectSmoothedRTT { 9000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without pacing, the whole window goes at once", cfg };
+      connect( test, isn, 10000, 12 );
+      test.execute( Push( string( 10 * MSS, 'x' ) ) );
+      expect_segments( test, 10 );
+      test.execute( ExpectMsUntilNextSend { nullopt } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Pacing spreads the window over the RTT", cfg };
+      test.execute( SetPacing {} );
+      connect( test, isn, 10000, 12 );
+
+      // 10000 bytes per 12 ms, at a gain of 1.2: a segment per millisecond, after a millisecond's worth of credit.
+      test.execute( Push( string( 10 * MSS, 'x' ) ) );
+      expect_segments( test, 2 );
+      test.execute( ExpectMsUntilNextSend { 1 } );
+      test.execute( Tick { 1 } );
+      expect_segments( test, 1 );
+      test.execute( Tick { 2 } );
+      expect_segments( test, 2 );
+
+      // A late tick does not release a burst: just the segment that was due, and a millisecond's worth of credit.
+      test.execute( Tick { 10 } );
+      expect_segments( test, 2 );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( Tick { 1 } );
+        expect_segments( test, 1 );
+      }
+      test.execute( ExpectMsUntilNextSend { nullopt } );
+      test.execute( ExpectSeqnosInFlight { 10 * MSS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "In slow start, pacing goes at twice the window per RTT", cfg, CongestionControl::Algorithm::NewReno };
+      test.execute( SetPacing {} );
+      connect( test, isn, 60000, 10 );
+
+      // Ten segments per 10 ms, at a gain of 2: a segment every half millisecond.
+      test.execute( Push( string( 20 * MSS, 'x' ) ) );
+      expect_segments( test, 3 );
+      test.execute( ExpectMsUntilNextSend { 1 } );
+      test.execute( Tick { 1 } );
+      expect_segments( test, 2 );
+      test.execute( Tick { 1 } );
+      expect_segments( test, 2 );
+      test.execute( Tick { 1 } );
+      expect_segments( test, 2 );
+      test.execute( Tick { 1 } );
+      expect_segments( test, 1 );
+      test.execute( ExpectMsUntilNextSend { nullopt } );
+
+      // Retransmissions are not paced.
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
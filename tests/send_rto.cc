@@ -0,0 +1,139 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+// Send a segment, and expect it to be retransmitted after `RTO_ms`.
+static void expect_timeout( TCPSenderTestHarness& test, Wrap32 seqno, uint64_t RTO_ms )
+{
+  test.execute( Tick { RTO_ms - 1 } );
+  test.execute( ExpectNoSegment {} );
+  test.execute( Tick { 1 } );
+  test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seqno ) );
+  test.execute( ExpectNoSegment {} );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without adaptive RTO, the RTO stays at its initial value", cfg };
+      connect( test, isn, WIN, 100 );
+      test.execute( ExpectSmoothedRTT { 100000 } );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The RTO follows SRTT and RTTVAR", cfg };
+      test.execute( SetAdaptiveRTO { 1, 60000 } );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      connect( test, isn, WIN, 100 );
+      test.execute( ExpectSmoothedRTT { 100000 } );
+      test.execute( ExpectRTTVariance { 50000 } );
+      test.execute( ExpectRTO { 300 } ); // SRTT + 4 RTTVAR
+
+      test.execute( ExpectMsUntilTimeout { nullopt } );
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( ExpectMsUntilTimeout { 300 } );
+      test.execute( Tick { 60 } );
+      test.execute( ExpectMsUntilTimeout { 240 } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ) );
+      test.execute( ExpectMsUntilTimeout { nullopt } );
+      test.execute( ExpectRTTVariance { 47500 } ); // 3/4 of 50 ms plus 1/4 of |100 ms - 60 ms|
+      test.execute( ExpectSmoothedRTT { 95000 } ); // 7/8 of 100 ms plus 1/8 of 60 ms
+      test.execute( ExpectRTO { 285 } );
+
+      // The timer runs for the RTO, doubling after each timeout.
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      expect_timeout( test, isn + 1 + MSS, 285 );
+      expect_timeout( test, isn + 1 + MSS, 570 );
+
+      // Karn's rule: the ACK of a retransmitted segment is not an RTT sample.
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN ) );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      test.execute( ExpectSmoothedRTT { 95000 } );
+      test.execute( ExpectRTO { 285 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The RTO and its backoff stay within their bounds", cfg };
+      test.execute( SetAdaptiveRTO { 200, 400 } );
+      connect( test, isn, WIN, 2 );
+      test.execute( ExpectSmoothedRTT { 2000 } );
+      test.execute( ExpectRTO { 200 } ); // not 6 ms
+
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      expect_timeout( test, isn + 1, 200 );
+      expect_timeout( test, isn + 1, 400 );
+      expect_timeout( test, isn + 1, 400 );
+      test.execute( ExpectConsecutiveRetransmissions { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Karn's rule holds for a segment retransmitted on a partial ACK", cfg };
+      connect( test, isn, WIN, 100 );
+      test.execute( Push( string( 8 * MSS, 'x' ) ) );
+      for ( uint64_t i = 0; i < 8; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + i * MSS ) );
+      }
+
+      // The first segment is lost, and retransmitted once three are SACKed past it.
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( isn + 1 + MSS, isn + 1 + 4 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 ) );
+
+      // A new segment, sent during recovery, is the one timed...
+      test.execute( Tick { 10 } );
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 8 * MSS ) );
+
+      // ...until a partial ACK, with everything before it SACKed, retransmits it.
+      test.execute( Tick { 10 } );
+      test.execute(
+        AckReceived { isn + 1 + 6 * MSS }.with_win( WIN ).with_sack( isn + 1 + 6 * MSS, isn + 1 + 8 * MSS ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( isn + 1 + 8 * MSS ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 + 9 * MSS }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectSmoothedRTT { 100000 } ); // no sample from the retransmitted segment
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
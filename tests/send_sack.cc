@@ -0,0 +1,123 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+// Connect, and send eight segments.
+static void send_eight( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  connect( test, isn, WIN );
+  test.execute( Push( string( 8 * MSS, 'x' ) ) );
+  for ( uint64_t i = 0; i < 8; i++ ) {
+    test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ).with_seqno( isn + 1 + i * MSS ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+// The sequence number of the start of segment `i`
+static Wrap32 seg( Wrap32 isn, uint64_t i )
+{
+  return isn + 1 + i * MSS;
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Enough SACKed past a hole calls it lost, before three duplicate ACKs", cfg };
+      send_eight( test, isn );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( seg( isn, 1 ), seg( isn, 4 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( isn, 8 ) }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Several holes are retransmitted, one per ACK, skipping SACKed segments", cfg };
+      send_eight( test, isn );
+
+      // Segments 0, 2 and 5 are lost.
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( seg( isn, 1 ), seg( isn, 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 }
+                      .with_win( WIN )
+                      .with_sack( seg( isn, 3 ), seg( isn, 5 ) )
+                      .with_sack( seg( isn, 1 ), seg( isn, 2 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 }
+                      .with_win( WIN )
+                      .with_sack( seg( isn, 6 ), seg( isn, 8 ) )
+                      .with_sack( seg( isn, 3 ), seg( isn, 5 ) )
+                      .with_sack( seg( isn, 1 ), seg( isn, 2 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Only two segments are SACKed past segment 5: not enough to call it lost yet.
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_sack( seg( isn, 6 ), seg( isn, 8 ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // The partial ACK of the first retransmission is.
+      test.execute( AckReceived { seg( isn, 2 ) }.with_win( WIN ).with_sack( seg( isn, 3 ), seg( isn, 5 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 5 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( isn, 5 ) }.with_win( WIN ).with_sack( seg( isn, 6 ), seg( isn, 8 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { seg( isn, 8 ) }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test {
+        "After a timeout, SACKed holes are retransmitted without another window reduction",
+        cfg,
+        CongestionControl::Algorithm::NewReno };
+      send_eight( test, isn );
+
+      // Segments 0 and 2 are lost.
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 0 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { MSS } );
+      test.execute( ExpectSlowStartThreshold { 4 * MSS } );
+
+      test.execute( AckReceived { seg( isn, 2 ) }.with_win( WIN ).with_sack( seg( isn, 3 ), seg( isn, 8 ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_seqno( seg( isn, 2 ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 2 * MSS } );
+      test.execute( ExpectSlowStartThreshold { 4 * MSS } );
+      test.execute( AckReceived { seg( isn, 8 ) }.with_win( WIN ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
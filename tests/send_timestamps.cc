@@ -0,0 +1,121 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+static constexpr uint16_t WIN = 60000;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without timestamps, messages are not stamped", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( nullopt ) );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ) );
+      test.execute( ExpectSeqno { isn + 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Each message carries the time it was sent", cfg };
+      test.execute( SetTimestamps {} );
+      test.execute( Tick { 5 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 5 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_timestamp_echo( 5 ) );
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 15 ) );
+
+      // A retransmission is stamped afresh.
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 15 + cfg.rt_timeout ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "The echo times every round trip, even of a retransmission", cfg };
+      test.execute( SetTimestamps {} );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectSmoothedRTT { 20000 } );
+
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 20 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 20 + cfg.rt_timeout ) );
+      test.execute( Tick { 30 } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ).with_timestamp_echo( 20 + cfg.rt_timeout ) );
+      test.execute( ExpectSmoothedRTT { 21250 } ); // 7/8 of 20 ms plus 1/8 of 30 ms
+
+      // A duplicate ACK is not a sample.
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ).with_timestamp_echo( 20 + cfg.rt_timeout ) );
+      test.execute( ExpectSmoothedRTT { 21250 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "An echo from the future or from before the data was sent is ignored", cfg };
+      test.execute( SetTimestamps {} );
+      test.execute( SetAdaptiveRTO { 1, 60000 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { isn + 1 }.with_win( WIN ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectSmoothedRTT { 20000 } );
+      test.execute( ExpectRTO { 60 } ); // 20 ms, plus 4 times 10 ms of variation
+
+      // A stamp we have not sent yet
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 20 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 + MSS }.with_win( WIN ).with_timestamp_echo( 500 ) );
+      test.execute( ExpectSmoothedRTT { 20000 } );
+      test.execute( ExpectRTO { 60 } );
+
+      // A stamp older than the data it acknowledges
+      test.execute( Push( string( MSS, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( MSS ).with_timestamp( 30 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 1 + 2 * MSS }.with_win( WIN ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectSmoothedRTT { 20000 } );
+      test.execute( ExpectRTO { 60 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.send_capacity = 1 << 20;
+
+      TCPSenderTestHarness test { "A scaled window lets the sender fill more than 64 KiB", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( SetWindowScale { 4 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push( string( 200 * MSS, 'x' ) ) );
+      for ( uint64_t i = 0; i < 160; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 160 * MSS } );
+
+      // An ACK of half, advertising the same scaled window, opens room for half again.
+      test.execute( AckReceived { isn + 1 + 80 * MSS }.with_win( 10000 ) );
+      for ( uint64_t i = 0; i < 40; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "A scaled window is in flight from the ackno", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( SetWindowScale { 2 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 1000 ) );
+      test.execute( Push( string( 6 * MSS, 'x' ) ) );
+      for ( uint64_t i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // The window shrinks to 1000 bytes from the ackno, of which all are already in flight.
+      test.execute( AckReceived { isn + 1 + 3 * MSS }.with_win( 250 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1 + 4 * MSS }.with_win( 250 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( MSS ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
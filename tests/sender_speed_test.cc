@@ -0,0 +1,131 @@
+#include "byte_stream.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+
+// The application writes `segment_len` bytes at a time and pushes after each write, so a full window holds
+// window / segment_len messages. The receiver acknowledges every message separately, keeping the window
+// full: each round, the sender fills the window and the receiver acknowledges half of it. A window over 64 KiB
+// is advertised with window scaling. From a Chunked stream, each payload is a slice of the chunk it lies in.
+void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t window,      // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t segment_len, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed,
+                 const ByteStream::Storage storage = ByteStream::Storage::Ring )
+{
+  uint8_t shift = 0;
+  while ( ( window >> shift ) > UINT16_MAX ) {
+    shift++;
+  }
+  const auto advertised = static_cast<uint16_t>( window >> shift );
+
+  const string data = [&] {
+    default_random_engine rd { random_seed };
+    string ret( input_len, 0 );
+    generate( ret.begin(), ret.end(), [&] { return static_cast<char>( rd() ); } );
+    return ret;
+  }();
+
+  const Wrap32 isn { 0 };
+  TCPSender sender { 1000, isn };
+  sender.set_window_scale( shift );
+  ByteStream stream { window, storage };
+
+  string output_data;
+  output_data.reserve( input_len );
+  deque<TCPSenderMessage> in_flight;
+  uint64_t written = 0;
+  bool finished = false;
+
+  const auto start_time = steady_clock::now();
+
+  // The SYN takes the initial one-sequence-number window.
+  sender.push( stream.reader() );
+  sender.receive( { sender.maybe_send()->seqno + 1, advertised } );
+
+  while ( not finished ) {
+    while ( written < input_len and stream.writer().available_capacity() > 0 ) {
+      const size_t len = min( { segment_len, input_len - written, stream.writer().available_capacity() } );
+      stream.writer().push( data.substr( written, len ) );
+      written += len;
+      if ( written == input_len ) {
+        stream.writer().close();
+      }
+      sender.push( stream.reader() );
+    }
+    sender.push( stream.reader() ); // the stream may have been full while the window was
+
+    while ( auto msg = sender.maybe_send() ) {
+      in_flight.push_back( move( *msg ) );
+    }
+    if ( in_flight.empty() ) {
+      throw runtime_error( "TCPSender stalled with an open window" );
+    }
+
+    for ( size_t n = ( in_flight.size() + 1 ) / 2; n > 0; n-- ) {
+      const TCPSenderMessage& msg = in_flight.front();
+      output_data += string_view( msg.payload );
+      finished = msg.FIN;
+      sender.receive( { msg.seqno + msg.sequence_length(), advertised } );
+      in_flight.pop_front();
+    }
+  }
+
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and sent" );
+  }
+  if ( sender.sequence_numbers_in_flight() != 0 ) {
+    throw runtime_error( "TCPSender still has sequence numbers in flight" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto gigabits_per_second = 8 * static_cast<double>( input_len ) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "TCPSender with window=" << window << ", segment_len=" << segment_len
+       << ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ) << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             TCPSender throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.01 ) {
+    throw runtime_error( "TCPSender did not meet minimum speed of 0.01 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1e7, UINT16_MAX, 1000, 1380 );
+  speed_test( 1e7, UINT16_MAX, 64, 1381 );
+  speed_test( 1e6, UINT16_MAX, 1, 1382 );
+  speed_test( 1e7, UINT16_MAX, 1000, 1385, ByteStream::Storage::Chunked );
+  speed_test( 1e8, 1 << 20, 1000, 1383 );
+  speed_test( 1e8, 1 << 24, 1000, 1384 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@
 #include "tcp_sender.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <optional>
 #include <sstream>
 #include <utility>
@@ -28,6 +29,9 @@ static std::string to_string( const TCPSenderMessage& msg )
   if ( msg.FIN ) {
     o << " +FIN";
   }
+  if ( msg.timestamp.has_value() ) {
+    o << " TSval=" << msg.timestamp.value();
+  }
   o << ")";
   return o.str();
 }
@@ -61,6 +65,86 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<StreamAndSender, u
   uint64_t value( StreamAndSender& ss ) const override { return ss.second.consecutive_retransmissions(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow_start_threshold"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.slow_start_threshold(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<StreamAndSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "smoothed_rtt_us"; }
+  std::optional<uint64_t> value( StreamAndSender& ss ) const override { return ss.second.rtt_estimate().srtt_us; }
+};
+
+struct ExpectRTTVariance : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rttvar_us"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.rtt_estimate().rttvar_us; }
+};
+
+struct ExpectRTO : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTO_ms"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.rtt_estimate().RTO_ms; }
+};
+
+struct ExpectMsUntilNextSend : public ExpectNumber<StreamAndSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "ms_until_next_send"; }
+  std::optional<uint64_t> value( StreamAndSender& ss ) const override { return ss.second.ms_until_next_send(); }
+};
+
+struct ExpectMsUntilTimeout : public ExpectNumber<StreamAndSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "ms_until_timeout"; }
+  std::optional<uint64_t> value( StreamAndSender& ss ) const override { return ss.second.ms_until_timeout(); }
+};
+
+struct ExpectMSS : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.mss(); }
+};
+
+struct ExpectMTUSearchHigh : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "path_mtu_search.high"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.path_mtu_search().high; }
+};
+
+struct ExpectMTUProbe : public ExpectNumber<StreamAndSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "path_mtu_search.probe_size"; }
+  std::optional<uint64_t> value( StreamAndSender& ss ) const override
+  {
+    return ss.second.path_mtu_search().probe_size;
+  }
+};
+
+struct ExpectMTUProbeFailures : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "path_mtu_search.probe_failures"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.path_mtu_search().probe_failures; }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender>
 {
   std::string description() const override { return "nothing to send"; }
@@ -110,6 +194,101 @@ struct Push : public Action<StreamAndSender>
   }
 };
 
+struct SetPacing : public Action<StreamAndSender>
+{
+  bool enabled_;
+
+  explicit SetPacing( bool enabled = true ) : enabled_( enabled ) {}
+  std::string description() const override { return enabled_ ? "enable pacing" : "disable pacing"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_pacing( enabled_ ); }
+};
+
+struct SetMSS : public Action<StreamAndSender>
+{
+  uint64_t mss_;
+
+  explicit SetMSS( uint64_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "set_mss( " + std::to_string( mss_ ) + " )"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_mss( mss_ ); }
+};
+
+struct SetPathMTUDiscovery : public Action<StreamAndSender>
+{
+  uint64_t base_mss_;
+
+  explicit SetPathMTUDiscovery( uint64_t base_mss ) : base_mss_( base_mss ) {}
+  std::string description() const override
+  {
+    return "set_path_mtu_discovery( " + std::to_string( base_mss_ ) + " )";
+  }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_path_mtu_discovery( base_mss_ ); }
+};
+
+struct SetNagle : public Action<StreamAndSender>
+{
+  bool enabled_;
+
+  explicit SetNagle( bool enabled = true ) : enabled_( enabled ) {}
+  std::string description() const override { return enabled_ ? "enable Nagle" : "disable Nagle"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_nagle( enabled_ ); }
+};
+
+struct SetAutocork : public Action<StreamAndSender>
+{
+  bool enabled_;
+
+  explicit SetAutocork( bool enabled = true ) : enabled_( enabled ) {}
+  std::string description() const override { return enabled_ ? "enable autocork" : "disable autocork"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_autocork( enabled_ ); }
+};
+
+struct SetCork : public Action<StreamAndSender>
+{
+  bool enabled_;
+
+  explicit SetCork( bool enabled = true ) : enabled_( enabled ) {}
+  std::string description() const override { return enabled_ ? "cork" : "uncork"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_cork( enabled_ ); }
+};
+
+struct Flush : public Action<StreamAndSender>
+{
+  std::string description() const override { return "flush"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.flush( ss.first.reader() ); }
+};
+
+struct SetAdaptiveRTO : public Action<StreamAndSender>
+{
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+
+  SetAdaptiveRTO( uint64_t min_RTO_ms, uint64_t max_RTO_ms ) : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max_RTO_ms )
+  {}
+  std::string description() const override
+  {
+    return "set_adaptive_RTO( " + std::to_string( min_RTO_ms_ ) + ", " + std::to_string( max_RTO_ms_ ) + " )";
+  }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_adaptive_RTO( min_RTO_ms_, max_RTO_ms_ ); }
+};
+
+struct SetTimestamps : public Action<StreamAndSender>
+{
+  bool enabled_;
+
+  explicit SetTimestamps( bool enabled = true ) : enabled_( enabled ) {}
+  std::string description() const override { return enabled_ ? "enable timestamps" : "disable timestamps"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_timestamps( enabled_ ); }
+};
+
+struct SetWindowScale : public Action<StreamAndSender>
+{
+  uint8_t shift_;
+
+  explicit SetWindowScale( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "set_window_scale( " + std::to_string( shift_ ) + " )"; }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_window_scale( shift_ ); }
+};
+
 struct Tick : public Action<StreamAndSender>
 {
   uint64_t ms_;
@@ -156,12 +335,22 @@ struct Receive : public Action<StreamAndSender>
 {
   TCPReceiverMessage msg_;
   bool push_ = true;
+  bool with_data_ = false;
 
   explicit Receive( TCPReceiverMessage msg ) : msg_( msg ) {}
   std::string description() const override
   {
     std::ostringstream desc;
     desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << " TSecr=" << msg_.timestamp_echo.value();
+    }
+    for ( const auto& [left, right] : msg_.sack_blocks ) {
+      desc << " SACK [" << to_string( left ) << ", " << to_string( right ) << ")";
+    }
+    if ( with_data_ ) {
+      desc << " on a segment with data";
+    }
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -176,7 +365,7 @@ struct Receive : public Action<StreamAndSender>
 
   void execute( StreamAndSender& ss ) const override
   {
-    ss.second.receive( msg_ );
+    ss.second.receive( msg_, with_data_ );
     if ( push_ ) {
       ss.second.push( ss.first.reader() );
     }
@@ -187,6 +376,24 @@ struct Receive : public Action<StreamAndSender>
     push_ = false;
     return *this;
   }
+
+  Receive& with_data()
+  {
+    with_data_ = true;
+    return *this;
+  }
+
+  Receive& with_timestamp_echo( uint32_t timestamp )
+  {
+    msg_.timestamp_echo = timestamp;
+    return *this;
+  }
+
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack_blocks.push_back( { left, right } );
+    return *this;
+  }
 };
 
 struct AckReceived : public Receive
@@ -206,6 +413,7 @@ struct ExpectMessage : public Expectation<StreamAndSender>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<std::optional<uint32_t>> timestamp {};
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -246,6 +454,12 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     return *this;
   }
 
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
   std::string message_description() const
   {
     std::ostringstream o;
@@ -268,6 +482,9 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( fin.has_value() ) {
       o << ( fin.value() ? " +FIN" : " (no FIN)" );
     }
+    if ( timestamp.has_value() ) {
+      o << " TSval=" << to_string( timestamp.value() );
+    }
     return o.str();
   }
 
@@ -294,10 +511,13 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw ExpectationViolation( "sequence number", seqno.value(), seg.seqno );
     }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      throw ExpectationViolation( "timestamp", timestamp.value(), seg.timestamp );
+    }
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > std::max( ss.second.mss(), ss.second.path_mtu_search().high ) ) { // or a probe's
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -311,9 +531,26 @@ struct ExpectMessage : public Expectation<StreamAndSender>
 class TCPSenderTestHarness : public TestHarness<StreamAndSender>
 {
 public:
-  TCPSenderTestHarness( std::string name, TCPConfig config )
+  // Unless a test asks for congestion control, the sender is limited only by the receiver's window.
+  TCPSenderTestHarness( std::string name,
+                        TCPConfig config,
+                        CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None )
     : TestHarness( move( name ),
-                   "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { ByteStream { config.send_capacity }, TCPSender { config.rt_timeout, config.fixed_isn } } )
+                   "initial_RTO_ms=" + to_string( config.rt_timeout )
+                     + ( congestion_control == CongestionControl::Algorithm::NewReno ? ", NewReno" : "" )
+                     + ( congestion_control == CongestionControl::Algorithm::Cubic ? ", CUBIC" : "" ),
+                   { ByteStream { config.send_capacity },
+                     TCPSender { config.rt_timeout, config.fixed_isn, congestion_control } } )
   {}
 };
+
+// Send the SYN, and acknowledge it `rtt_ms` later with a window of `win`: the ACK is the first RTT sample.
+inline void connect( TCPSenderTestHarness& test, Wrap32 isn, uint16_t win, uint64_t rtt_ms = 0 )
+{
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+  test.execute( ExpectSmoothedRTT { std::nullopt } );
+  test.execute( Tick { rtt_ms } );
+  test.execute( AckReceived { isn + 1 }.with_win( win ) );
+  test.execute( ExpectSmoothedRTT { rtt_ms * 1000 } );
+}
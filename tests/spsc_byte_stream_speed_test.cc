@@ -0,0 +1,152 @@
+#include "exception.hh"
+#include "file_descriptor.hh"
+#include "spsc_byte_stream.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+// Both tests hand `data` from a writer thread to a reader thread in pieces of `write_size` bytes,
+// the way the owner of a TCPMinnowSocket hands bytes to its TCPPeer thread.
+
+static duration<double> socketpair_test( const string& data, const size_t write_size )
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "socketpair", ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds.data() ) );
+  FileDescriptor writer_end { fds[0] };
+  FileDescriptor reader_end { fds[1] };
+
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  thread writer { [&] {
+    for ( size_t i = 0; i < data.size(); i += write_size ) {
+      string_view piece = string_view( data ).substr( i, write_size );
+      while ( not piece.empty() ) {
+        piece.remove_prefix( writer_end.write( piece ) );
+      }
+    }
+    writer_end.close();
+  } };
+
+  string buffer;
+  while ( not reader_end.eof() ) {
+    buffer.resize( 65536 );
+    reader_end.read( buffer );
+    output_data += buffer;
+  }
+  writer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read through socketpair" );
+  }
+
+  return duration_cast<duration<double>>( stop_time - start_time );
+}
+
+static duration<double> spsc_test( const string& data, const size_t capacity, const size_t write_size )
+{
+  SPSCByteStream stream { capacity };
+
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  thread writer { [&] {
+    for ( size_t i = 0; i < data.size(); i += write_size ) {
+      string_view piece = string_view( data ).substr( i, write_size );
+      while ( not piece.empty() ) {
+        stream.wait_writable();
+        piece.remove_prefix( stream.push( piece ) );
+      }
+    }
+    stream.close();
+  } };
+
+  while ( true ) {
+    stream.wait_readable();
+    if ( stream.is_finished() ) {
+      break;
+    }
+    const auto peeked = stream.peek();
+    output_data += peeked;
+    stream.pop( peeked.size() );
+  }
+  writer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read through SPSCByteStream" );
+  }
+
+  return duration_cast<duration<double>>( stop_time - start_time );
+}
+
+void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t write_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  // Generate the data to be written
+  const string data = [&random_seed, &input_len] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  const auto socketpair_duration = socketpair_test( data, write_size );
+  const auto spsc_duration = spsc_test( data, capacity, write_size );
+
+  auto gigabits_per_second
+    = [&]( duration<double> d ) { return 8 * static_cast<double>( input_len ) / d.count() / 1e9; };
+  auto ns_per_byte = [&]( duration<double> d ) { return d.count() * 1e9 / static_cast<double>( input_len ); };
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Thread handoff with write_size=" << write_size << ": socketpair reached " << fixed << setprecision( 2 )
+       << gigabits_per_second( socketpair_duration ) << " Gbit/s (" << ns_per_byte( socketpair_duration )
+       << " ns/byte), SPSCByteStream with capacity=" << capacity << " reached "
+       << gigabits_per_second( spsc_duration ) << " Gbit/s (" << ns_per_byte( spsc_duration ) << " ns/byte).\n";
+
+  debug_output << "             SPSCByteStream throughput: " << fixed << setprecision( 2 )
+               << gigabits_per_second( spsc_duration ) << " Gbit/s\n";
+
+  if ( gigabits_per_second( spsc_duration ) < 0.1 ) {
+    throw runtime_error( "SPSCByteStream did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1e7, 64000, 789, 1500 );
+  speed_test( 1e7, 64000, 790, 16384 );
+  speed_test( 1e7, 1048576, 791, 1500 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#include "spsc_byte_stream.hh"
+
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+static void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "SPSCByteStream: " + what );
+  }
+}
+
+static void capacity_test()
+{
+  bool threw = false;
+  try {
+    const SPSCByteStream stream { 0 };
+  } catch ( const runtime_error& ) {
+    threw = true;
+  }
+  expect( threw, "a stream with no capacity should have been rejected" );
+}
+
+// One thread: the ring wraps around, and peek() stops at its end.
+static void wraparound_test()
+{
+  SPSCByteStream stream { 5 };
+  expect( stream.push( "abc" ) == 3, "push into an empty stream" );
+  expect( stream.peek() == "abc", "peek after the first push" );
+  stream.pop( 3 );
+
+  expect( stream.push( "defgh" ) == 5, "push across the end of the ring" );
+  expect( stream.push( "i" ) == 0, "push into a full stream" );
+  expect( stream.available_capacity() == 0, "available capacity of a full stream" );
+  expect( stream.peek() == "de", "peek should stop at the end of the ring" );
+  stream.pop( 2 );
+  expect( stream.peek() == "fgh", "peek from the front of the ring" );
+  expect( stream.push( "ijk" ) == 2, "push should stop at the capacity" );
+  stream.pop( 3 );
+  expect( stream.peek() == "ij", "peek after popping across the end of the ring" );
+  expect( stream.bytes_pushed() == 10 and stream.bytes_popped() == 8, "byte counts" );
+}
+
+// One thread: closing leaves the buffered bytes to be read, and wakes up a reader without blocking.
+static void close_test()
+{
+  SPSCByteStream stream { 8 };
+  stream.push( "xy" );
+  stream.close();
+  expect( stream.is_closed() and not stream.is_finished(), "a closed stream with bytes left is not finished" );
+  stream.wait_readable();
+  expect( stream.peek() == "xy", "peek after close" );
+  stream.pop( 2 );
+  expect( stream.is_finished(), "a closed and emptied stream is finished" );
+  stream.wait_readable(); // must not block
+}
+
+// Two threads: every byte arrives once and in order, through a stream small enough to fill up and wrap
+// around many times, with each side sleeping on its eventfd whenever it has to wait.
+static void ordering_test( size_t input_len, size_t capacity, size_t random_seed ) // NOLINT(*-swappable-*)
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string data;
+  for ( size_t i = 0; i < input_len; ++i ) {
+    data += ud( rd );
+  }
+
+  SPSCByteStream stream { capacity };
+  thread writer { [&, seed = random_seed + 1] {
+    default_random_engine write_rd { seed };
+    uniform_int_distribution<size_t> write_size { 1, 2 * capacity };
+    string_view rest = data;
+    while ( not rest.empty() ) {
+      stream.wait_writable();
+      rest.remove_prefix( stream.push( rest.substr( 0, write_size( write_rd ) ) ) );
+    }
+    stream.close();
+  } };
+
+  uniform_int_distribution<size_t> read_size { 1, capacity };
+  string output;
+  while ( true ) {
+    stream.wait_readable();
+    if ( stream.is_finished() ) {
+      break;
+    }
+    const string_view peeked = stream.peek().substr( 0, read_size( rd ) );
+    output += peeked;
+    stream.pop( peeked.size() );
+  }
+  writer.join();
+
+  expect( output == data, "bytes were lost, duplicated or reordered between threads" );
+  expect( stream.bytes_popped() == input_len, "bytes popped after the transfer" );
+}
+
+// Two threads: an error wakes up a reader asleep on an empty stream.
+static void error_test()
+{
+  SPSCByteStream stream { 8 };
+  thread reader { [&] { stream.wait_readable(); } };
+  stream.set_error();
+  reader.join();
+  expect( stream.has_error(), "has_error() after set_error()" );
+}
+
+int main()
+{
+  try {
+    capacity_test();
+    wraparound_test();
+    close_test();
+    ordering_test( 100000, 7, 1234 );
+    ordering_test( 100000, 4096, 1235 );
+    error_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include "tcp_minnow_socket.cc"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+// Carries IPv4 datagrams over one end of a socketpair, so that two TCPMinnowSockets can talk to each other
+// without a TUN device.
+class LoopbackAdapter : public TCPOverIPv4Adapter
+{
+  FileDescriptor _fd;
+
+public:
+  explicit LoopbackAdapter( FileDescriptor&& fd ) : _fd( move( fd ) ) {}
+
+  optional<TCPSegment> read()
+  {
+    vector<string> strs( 2 );
+    strs.front().resize( IPv4Header::LENGTH );
+    _fd.read( strs );
+
+    InternetDatagram ip_dgram;
+    const vector<Buffer> buffers = { strs.at( 0 ), strs.at( 1 ) };
+    if ( parse( ip_dgram, buffers ) ) {
+      return unwrap_tcp_in_ip( ip_dgram );
+    }
+    return {};
+  }
+
+  void write( TCPSegment& seg ) { _fd.write( serialize( wrap_tcp_in_ip( seg ) ) ); }
+
+  FileDescriptor& fd() { return _fd; }
+};
+
+template class TCPMinnowSocket<LoopbackAdapter>;
+
+static const Address CLIENT_ADDRESS { "10.0.0.1", 4321 };
+static const Address SERVER_ADDRESS { "10.0.0.2", 1234 };
+
+static void send_some( SPSCByteStream& stream, string_view data )
+{
+  while ( not data.empty() ) {
+    stream.wait_writable();
+    if ( stream.has_error() ) {
+      throw runtime_error( "outbound stream failed" );
+    }
+    data.remove_prefix( stream.push( data ) );
+  }
+}
+
+static void send_all( SPSCByteStream& stream, string_view data )
+{
+  send_some( stream, data );
+  stream.close();
+}
+
+static string receive_all( SPSCByteStream& stream )
+{
+  string data;
+  while ( true ) {
+    stream.wait_readable();
+    if ( stream.has_error() ) {
+      throw runtime_error( "inbound stream failed" );
+    }
+    if ( stream.is_finished() ) {
+      return data;
+    }
+    data += stream.peek();
+    stream.pop( stream.peek().size() );
+  }
+}
+
+// The client sends `data` through its shared outbound stream; the server reads it all from its shared inbound
+// stream and sends it back. The streams are much smaller than `data`, so both wrap around many times.
+static void round_trip_test( size_t input_len,         // NOLINT(bugprone-easily-swappable-parameters)
+                             uint64_t stream_capacity, // NOLINT(bugprone-easily-swappable-parameters)
+                             size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string data;
+  for ( size_t i = 0; i < input_len; ++i ) {
+    data += ud( rd );
+  }
+
+  auto [client_fd, server_fd] = socket_pair_helper( SOCK_DGRAM );
+  TCPMinnowSocket<LoopbackAdapter> client { LoopbackAdapter( move( client_fd ) ) };
+  TCPMinnowSocket<LoopbackAdapter> server { LoopbackAdapter( move( server_fd ) ) };
+  client.use_shared_streams( stream_capacity );
+  server.use_shared_streams( stream_capacity );
+
+  exception_ptr server_error;
+  thread server_thread { [&] {
+    try {
+      FdAdapterConfig server_config;
+      server_config.source = SERVER_ADDRESS;
+      server.listen_and_accept( {}, server_config );
+      send_all( server.outbound_stream(), receive_all( server.inbound_stream() ) );
+      server.wait_until_closed();
+    } catch ( ... ) {
+      server_error = current_exception();
+    }
+  } };
+
+  FdAdapterConfig client_config;
+  client_config.source = CLIENT_ADDRESS;
+  client_config.destination = SERVER_ADDRESS;
+  client.connect( {}, client_config );
+  send_all( client.outbound_stream(), data );
+  const string echoed = receive_all( client.inbound_stream() );
+  client.wait_until_closed();
+  server_thread.join();
+  if ( server_error ) {
+    rethrow_exception( server_error );
+  }
+
+  if ( echoed != data ) {
+    throw runtime_error( "Mismatch between data sent and echoed through TCPMinnowSocket shared streams" );
+  }
+}
+
+// A corked client's short write waits for flush(). The server only closes its side once the write has arrived,
+// so without the flush neither side would finish.
+static void flush_test()
+{
+  auto [client_fd, server_fd] = socket_pair_helper( SOCK_DGRAM );
+  TCPMinnowSocket<LoopbackAdapter> client { LoopbackAdapter( move( client_fd ) ) };
+  TCPMinnowSocket<LoopbackAdapter> server { LoopbackAdapter( move( server_fd ) ) };
+  client.use_shared_streams();
+  server.use_shared_streams();
+
+  string received;
+  exception_ptr server_error;
+  thread server_thread { [&] {
+    try {
+      FdAdapterConfig server_config;
+      server_config.source = SERVER_ADDRESS;
+      server.listen_and_accept( {}, server_config );
+      SPSCByteStream& inbound = server.inbound_stream();
+      while ( received.size() < 4 and not inbound.is_finished() and not inbound.has_error() ) {
+        inbound.wait_readable();
+        received += inbound.peek();
+        inbound.pop( inbound.peek().size() );
+      }
+      server.outbound_stream().close();
+      received += receive_all( inbound );
+      server.wait_until_closed();
+    } catch ( ... ) {
+      server_error = current_exception();
+    }
+  } };
+
+  TCPConfig client_tcp_config;
+  client_tcp_config.cork = true;
+  FdAdapterConfig client_config;
+  client_config.source = CLIENT_ADDRESS;
+  client_config.destination = SERVER_ADDRESS;
+  client.connect( client_tcp_config, client_config );
+  send_some( client.outbound_stream(), "ping" );
+  client.flush();
+  receive_all( client.inbound_stream() );
+  client.outbound_stream().close();
+  client.wait_until_closed();
+  server_thread.join();
+  if ( server_error ) {
+    rethrow_exception( server_error );
+  }
+
+  if ( received != "ping" ) {
+    throw runtime_error( "A flushed write did not arrive through a corked TCPMinnowSocket" );
+  }
+}
+
+int main()
+{
+  try {
+    round_trip_test( 200000, 1000, 4321 );
+    flush_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
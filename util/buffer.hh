@@ -2,22 +2,47 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
 class Buffer
 {
   std::shared_ptr<std::string> buffer_;
 
+  // A slice views part of the shared string; by default a Buffer views all of it.
+  size_t offset_ {};
+  size_t length_ { std::string::npos };
+
+  bool is_slice() const { return offset_ != 0 or length_ != std::string::npos; }
+
 public:
   // NOLINTBEGIN(*-explicit-*)
 
   Buffer( std::string str = {} ) : buffer_( make_shared<std::string>( std::move( str ) ) ) {}
-  operator std::string_view() const { return *buffer_; }
-  operator std::string&() { return *buffer_; }
+  operator std::string_view() const { return std::string_view( *buffer_ ).substr( offset_, length_ ); }
+
+  // Mutable access gives a slice its own copy of its bytes first.
+  operator std::string&()
+  {
+    if ( is_slice() ) {
+      *this = Buffer( std::string( std::string_view( *this ) ) );
+    }
+    return *buffer_;
+  }
 
   // NOLINTEND(*-explicit-*)
 
-  std::string&& release() { return std::move( *buffer_ ); }
-  size_t size() const { return buffer_->size(); }
-  size_t length() const { return buffer_->length(); }
-  bool empty() const { return buffer_->empty(); }
+  // A Buffer of up to `len` bytes starting at `pos`, sharing this Buffer's storage (no copy)
+  Buffer slice( size_t pos, size_t len = std::string::npos ) const
+  {
+    const std::string_view view = std::string_view( *this ).substr( pos, len );
+    Buffer ret { *this };
+    ret.offset_ = offset_ + pos;
+    ret.length_ = view.size();
+    return ret;
+  }
+
+  std::string&& release() { return std::move( static_cast<std::string&>( *this ) ); }
+  size_t size() const { return std::string_view( *this ).size(); }
+  size_t length() const { return size(); }
+  bool empty() const { return size() == 0; }
 };
@@ -0,0 +1,34 @@
+#include "eventfd.hh"
+
+#include "exception.hh"
+
+#include <cstdint>
+#include <poll.h>
+#include <string>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+EventFD::EventFD() : FileDescriptor( ::CheckSystemCall( "eventfd", ::eventfd( 0, EFD_CLOEXEC ) ) )
+{
+  set_blocking( false );
+}
+
+void EventFD::notify()
+{
+  const uint64_t one = 1;
+  write( { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+void EventFD::clear()
+{
+  string counter( sizeof( uint64_t ), 0 );
+  read( counter ); // non-blocking: returns without reading if nothing was signalled
+}
+
+void EventFD::wait()
+{
+  pollfd pfd { fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+  clear();
+}
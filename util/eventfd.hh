@@ -0,0 +1,14 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+//! A non-blocking [eventfd](\ref man2::eventfd) that one thread signals and another polls (e.g. in an EventLoop)
+class EventFD : public FileDescriptor
+{
+public:
+  EventFD();
+
+  void notify(); //!< Make the fd readable (signals before the next clear() coalesce)
+  void clear();  //!< Consume a pending signal, if any
+  void wait();   //!< Block until signalled, then consume the signal
+};
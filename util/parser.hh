@@ -65,11 +65,7 @@ class Parser
       if ( empty() ) {
         return;
       }
-      std::string first_str = std::move( buffer_.front() );
-      if ( skip_ ) {
-        first_str = first_str.substr( skip_ );
-      }
-      out.emplace_back( std::move( first_str ) );
+      out.push_back( skip_ ? buffer_.front().slice( skip_ ) : std::move( buffer_.front() ) );
       buffer_.pop_front();
       for ( auto&& x : buffer_ ) {
         out.emplace_back( std::move( x ) );
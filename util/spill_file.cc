@@ -0,0 +1,97 @@
+#include "spill_file.hh"
+
+#include "exception.hh"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static FileDescriptor make_temp_file()
+{
+  const char* dir = getenv( "TMPDIR" ); // NOLINT(*-mt-unsafe)
+  string path = string( dir ? dir : "/tmp" ) + "/minnow-spill-XXXXXX";
+  FileDescriptor fd { CheckSystemCall( "mkostemp", ::mkostemp( path.data(), O_CLOEXEC ) ) };
+  CheckSystemCall( "unlink", ::unlink( path.c_str() ) );
+  return fd;
+}
+
+SpillFile::SpillFile( const SpillFile& other )
+{
+  *this = other;
+}
+
+SpillFile& SpillFile::operator=( const SpillFile& other )
+{
+  if ( this == &other ) {
+    return *this;
+  }
+
+  fd_.reset();
+  if ( not other.fd_.has_value() ) {
+    return *this;
+  }
+
+  fd_.emplace( make_temp_file() );
+  off_t in_offset = 0;
+  off_t out_offset = 0;
+  struct stat info {};
+  CheckSystemCall( "fstat", ::fstat( other.fd_->fd_num(), &info ) );
+  const off_t size = info.st_size;
+  while ( in_offset < size ) {
+    const ssize_t copied = ::copy_file_range(
+      other.fd_->fd_num(), &in_offset, fd_->fd_num(), &out_offset, size - in_offset, 0 );
+    if ( copied <= 0 ) {
+      throw unix_error { "copy_file_range" };
+    }
+  }
+  return *this;
+}
+
+void SpillFile::write( uint64_t offset, string_view data )
+{
+  if ( not fd_.has_value() ) {
+    fd_.emplace( make_temp_file() );
+  }
+
+  while ( not data.empty() ) {
+    const ssize_t written = ::pwrite( fd_->fd_num(), data.data(), data.size(), static_cast<off_t>( offset ) );
+    if ( written <= 0 ) {
+      throw unix_error { "pwrite" };
+    }
+    data.remove_prefix( written );
+    offset += written;
+  }
+}
+
+void SpillFile::read( uint64_t offset, span<char> out ) const
+{
+  if ( not fd_.has_value() and not out.empty() ) {
+    throw runtime_error( "SpillFile::read() before any write" );
+  }
+
+  while ( not out.empty() ) {
+    const ssize_t bytes_read = ::pread( fd_->fd_num(), out.data(), out.size(), static_cast<off_t>( offset ) );
+    if ( bytes_read <= 0 ) {
+      throw unix_error { "pread" };
+    }
+    out = out.subspan( bytes_read );
+    offset += bytes_read;
+  }
+}
+
+void SpillFile::discard( uint64_t offset, uint64_t len )
+{
+  if ( not fd_.has_value() or len == 0 ) {
+    return;
+  }
+
+  // Best effort: not every filesystem can punch holes, and the bytes are dead either way.
+  ::fallocate( fd_->fd_num(),
+               FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, // NOLINT(*-signed-bitwise)
+               static_cast<off_t>( offset ),
+               static_cast<off_t>( len ) );
+}
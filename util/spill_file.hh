@@ -0,0 +1,34 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+//! \brief An anonymous temporary file that is read and written at explicit offsets
+//! \details The file is created on the first write and removed from the filesystem right away, so it
+//! disappears when closed. Unlike a FileDescriptor, a copy of a SpillFile gets its own file with the
+//! same contents.
+class SpillFile
+{
+  std::optional<FileDescriptor> fd_ {};
+
+public:
+  SpillFile() = default;
+  ~SpillFile() = default;
+  SpillFile( const SpillFile& other );
+  SpillFile& operator=( const SpillFile& other );
+  SpillFile( SpillFile&& other ) = default;
+  SpillFile& operator=( SpillFile&& other ) = default;
+
+  //! Write all of `data` at `offset`, growing the file if needed
+  void write( uint64_t offset, std::string_view data );
+
+  //! Read exactly `out.size()` bytes, previously written, from `offset`
+  void read( uint64_t offset, std::span<char> out ) const;
+
+  //! Release the disk space (and page cache) behind `len` bytes at `offset`, which will not be read again
+  void discard( uint64_t offset, uint64_t len );
+};
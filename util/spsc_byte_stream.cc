@@ -0,0 +1,126 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity )
+  : capacity_( capacity ), ring_( capacity, 0 )
+{
+  if ( capacity_ == 0 ) {
+    throw runtime_error( "SPSCByteStream needs a nonzero capacity" );
+  }
+}
+
+// The push/pop handshake below avoids lost wakeups. Each side publishes its own cursor (seq_cst) and then
+// reads the other side's (seq_cst). So either the writer sees that the reader had drained the stream (and
+// signals), or the reader's next look at `bytes_pushed_` sees the new bytes. The same holds for a full
+// stream with the roles swapped.
+
+uint64_t SPSCByteStream::push( string_view data )
+{
+  const uint64_t pushed = bytes_pushed_.load( memory_order_relaxed );
+  const uint64_t popped = bytes_popped_.load( memory_order_acquire );
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), capacity_ - ( pushed - popped ) );
+  if ( len == 0 ) {
+    return 0;
+  }
+
+  const uint64_t tail = pushed % capacity_;
+  const uint64_t first = min( len, capacity_ - tail );
+  memcpy( ring_.data() + tail, data.data(), first );
+  memcpy( ring_.data(), data.data() + first, len - first );
+
+  bytes_pushed_.store( pushed + len );
+  if ( bytes_popped_.load() == pushed ) {
+    readable_.notify(); // the stream was empty, so the reader may be asleep
+  }
+  return len;
+}
+
+void SPSCByteStream::close()
+{
+  closed_.store( true, memory_order_release );
+  readable_.notify();
+}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  readable_.notify();
+  writable_.notify();
+}
+
+uint64_t SPSCByteStream::available_capacity() const
+{
+  return capacity_ - ( bytes_pushed_.load( memory_order_relaxed ) - bytes_popped_.load() );
+}
+
+uint64_t SPSCByteStream::bytes_pushed() const
+{
+  return bytes_pushed_.load( memory_order_relaxed );
+}
+
+void SPSCByteStream::wait_writable()
+{
+  while ( available_capacity() == 0 and not has_error() ) {
+    writable_.wait();
+  }
+}
+
+void SPSCByteStream::clear_writable()
+{
+  writable_.clear();
+}
+
+string_view SPSCByteStream::peek() const
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t buffered = bytes_pushed_.load( memory_order_acquire ) - popped;
+  const uint64_t head = popped % capacity_;
+  return { ring_.data() + head, min( buffered, capacity_ - head ) };
+}
+
+void SPSCByteStream::pop( uint64_t len )
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  len = min( len, bytes_pushed_.load( memory_order_acquire ) - popped );
+  if ( len == 0 ) {
+    return;
+  }
+
+  bytes_popped_.store( popped + len );
+  if ( bytes_pushed_.load() - popped == capacity_ ) {
+    writable_.notify(); // the stream was full, so the writer may be asleep
+  }
+}
+
+bool SPSCByteStream::is_finished() const
+{
+  // Read `closed_` first: once it is set, `bytes_pushed_` is final.
+  return is_closed() and bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::bytes_buffered() const
+{
+  return bytes_pushed_.load() - bytes_popped_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCByteStream::bytes_popped() const
+{
+  return bytes_popped_.load( memory_order_relaxed );
+}
+
+void SPSCByteStream::wait_readable()
+{
+  while ( bytes_buffered() == 0 and not is_closed() and not has_error() ) {
+    readable_.wait();
+  }
+}
+
+void SPSCByteStream::clear_readable()
+{
+  readable_.clear();
+}
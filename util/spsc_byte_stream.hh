@@ -0,0 +1,60 @@
+#pragma once
+
+#include "eventfd.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//! \brief A fixed-capacity byte stream shared by exactly one writer thread and one reader thread
+//! \details Each side owns one cursor (an atomic count of bytes pushed or popped), so moving bytes
+//! takes no lock and no system call. Each direction also has an eventfd for sleeping: the writer
+//! signals `readable_fd()` when it pushes into an empty stream (or closes it), and the reader
+//! signals `writable_fd()` when it pops from a full one. Either fd can be polled, e.g. by an EventLoop.
+class SPSCByteStream
+{
+  uint64_t capacity_;
+  std::string ring_;
+
+  alignas( 64 ) std::atomic<uint64_t> bytes_pushed_ { 0 }; //!< Advanced only by the writer
+  alignas( 64 ) std::atomic<uint64_t> bytes_popped_ { 0 }; //!< Advanced only by the reader
+  std::atomic<bool> closed_ { false };
+  std::atomic<bool> error_ { false };
+
+  EventFD readable_ {}; //!< eventfd signalled when an empty stream gains bytes, closes or fails
+  EventFD writable_ {}; //!< eventfd signalled when a full stream loses bytes, or fails
+
+public:
+  explicit SPSCByteStream( uint64_t capacity ); //!< `capacity` must be nonzero
+
+  //! \name Writer thread
+  //!@{
+  uint64_t push( std::string_view data ); //!< Push as much of `data` as fits; returns the number of bytes pushed
+  void close();                           //!< Signal that nothing more will be pushed
+  uint64_t available_capacity() const;    //!< How many bytes can be pushed right now?
+  uint64_t bytes_pushed() const;          //!< Total number of bytes cumulatively pushed
+  void wait_writable();                   //!< Block until there is available capacity (or an error)
+  void clear_writable();                  //!< Consume a pending signal on writable_fd()
+  //!@}
+
+  //! \name Reader thread
+  //!@{
+  std::string_view peek() const;   //!< Peek at the next contiguous run of buffered bytes
+  void pop( uint64_t len );        //!< Remove `len` bytes from the stream
+  bool is_finished() const;        //!< Has the stream been closed and fully popped?
+  uint64_t bytes_buffered() const; //!< Number of bytes pushed and not yet popped
+  uint64_t bytes_popped() const;   //!< Total number of bytes cumulatively popped
+  void wait_readable();            //!< Block until there are buffered bytes, or the stream is closed (or failed)
+  void clear_readable();           //!< Consume a pending signal on readable_fd()
+  //!@}
+
+  //! \name Either thread
+  //!@{
+  void set_error(); //!< Signal that the stream suffered an error (wakes both sides)
+  bool is_closed() const { return closed_.load( std::memory_order_acquire ); }
+  bool has_error() const { return error_.load( std::memory_order_acquire ); }
+  FileDescriptor& readable_fd() { return readable_; }
+  FileDescriptor& writable_fd() { return writable_; }
+  //!@}
+};
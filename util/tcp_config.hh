@@ -1,6 +1,8 @@
 #pragma once
 
 #include "address.hh"
+#include "congestion_control.hh"
+#include "reassembler.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -12,7 +14,10 @@ class TCPConfig
 {
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size, until the MSS is settled
+  static constexpr uint16_t DEFAULT_MTU = 1500;     //!< Ethernet's MTU
+  static constexpr uint16_t MIN_MSS = 88;           //!< Least MSS (a peer's smaller offer is raised to it)
+  static constexpr uint16_t MIN_MTU = MIN_MSS + 40; //!< Least MTU: the least MSS, and the IPv4 and TCP headers
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
 
@@ -20,6 +25,21 @@ public:
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   std::optional<Wrap32> fixed_isn {};
+  Reassembler::Engine reassembler_engine = Reassembler::Engine::Map; //!< How to hold out-of-order bytes
+  uint64_t reassembler_limit = UINT64_MAX; //!< Most out-of-order bytes to hold (the farthest are dropped)
+  CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::NewReno; //!< Sender's cwnd
+  bool pacing = false;        //!< Spread each window of segments over a round trip, instead of sending it at once
+  bool adaptive_rto = true;   //!< Estimate the RTO from round-trip times (RFC 6298), starting from rt_timeout
+  uint64_t rto_min = 200;     //!< Least adaptive RTO, in milliseconds
+  uint64_t rto_max = 60000;   //!< Greatest adaptive RTO, in milliseconds, also bounding its exponential backoff
+  bool sack = true;           //!< Offer (and accept) selective acknowledgements, RFC 2018
+  bool window_scaling = true; //!< Offer (and accept) window scaling, RFC 7323, to advertise over 64 KiB
+  bool timestamps = true;     //!< Offer (and accept) timestamps, RFC 7323, for RTT samples and PAWS
+  bool nagle = false;         //!< Hold back a short segment while anything is unacknowledged (RFC 896)
+  bool autocork = false;      //!< Hold back a short segment while earlier ones wait to be sent (or acked)
+  bool cork = false;          //!< Hold back a short segment until flushed, like TCP_CORK
+  uint16_t mtu = DEFAULT_MTU; //!< Largest datagram the local link carries (our MSS is this less 40 bytes)
+  bool mtu_probing = false;   //!< Send MAX_PAYLOAD_SIZE segments at first, probing up to the MSS (RFC 4821)
 };
 
 //! Config for classes derived from FdAdapter
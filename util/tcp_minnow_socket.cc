@@ -5,6 +5,7 @@
 #include "parser.hh"
 #include "tun.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -18,7 +19,8 @@
 
 using namespace std;
 
-static constexpr size_t TCP_TICK_MS = 10;
+static constexpr size_t IDLE_TICK_MS = 1000; // with no TCP timer running, only the adapter's coarse timers are left
+static constexpr size_t MAX_READ_SIZE = 16384; // bytes read from the owner at once (each read is one chunk)
 
 static inline uint64_t timestamp_ms()
 {
@@ -33,7 +35,10 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const function<bool()>& condition )
 {
   auto base_time = timestamp_ms();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    // Sleep until an event, or until the sender's next timer (a paced segment or a retransmission) is due.
+    const auto next_timer = _tcp.has_value() ? _tcp->ms_until_next_timer() : nullopt;
+    const auto timeout_ms = min( IDLE_TICK_MS, next_timer.value_or( IDLE_TICK_MS ) );
+    auto ret = _eventloop.wait_next_event( static_cast<int>( timeout_ms ) );
     if ( ret == EventLoop::Result::Exit or _abort ) {
       break;
     }
@@ -49,6 +54,10 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const function<bool()>& condition )
       _datagram_adapter.tick( next_time - base_time );
       base_time = next_time;
     }
+
+    if ( _outbound_writable or _inbound_readable ) {
+      _exchange_shared_streams();
+    }
   }
 }
 
@@ -69,6 +78,13 @@ template<typename AdaptT>
 void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
 {
   _tcp.emplace( config );
+  _tcp->outbound_writer().on_writable( [&] { _outbound_writable = true; } );
+  _tcp->inbound_reader().on_readable( [&] { _inbound_readable = true; } );
+
+  // Only wake up to read from the owner once there is room for a full read.
+  if ( config.send_capacity > MAX_READ_SIZE ) {
+    _tcp->outbound_writer().set_high_watermark( config.send_capacity - MAX_READ_SIZE + 1 );
+  }
 
   // Set up the event loop
 
@@ -87,6 +103,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
   //
   // 4) Outbound segment generated by TCP (needs to be
   //    given to underlying datagram socket)
+  //
+  // 5) Flush requested by the owner (handled before 4, so
+  //    the flushed segments go out at once)
 
   // rule 1: read from filtered packet stream and dump into TCPConnection
   _eventloop.add_rule(
@@ -100,7 +119,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       }
 
       // debugging output:
-      if ( _thread_data.eof() and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
+      if ( _outbound_shutdown and _tcp.value().sender().sequence_numbers_in_flight() == 0 and not _fully_acked ) {
         cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string()
              << " has been fully acknowledged.\n";
         _fully_acked = true;
@@ -108,69 +127,108 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     },
     [&] { return _tcp->active(); } );
 
-  // rule 2: read from pipe into outbound buffer
-  _eventloop.add_rule(
-    "push bytes to TCPPeer",
-    _thread_data,
-    Direction::In,
-    [&] {
-      string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
-
-      if ( _thread_data.eof() ) {
+  if ( _shared_outbound.has_value() ) {
+    // rules 2 and 3, shared-memory version: the owner signals an eventfd after pushing to an empty
+    // outbound stream or popping from a full inbound stream, and _tcp_loop moves the bytes.
+    _eventloop.add_rule(
+      "push bytes from shared stream to TCPPeer",
+      _shared_outbound->readable_fd(),
+      Direction::In,
+      [&] {
+        _shared_outbound->clear_readable();
+        _exchange_shared_streams();
+      },
+      [&] { return _tcp->active() and not _outbound_shutdown; } );
+
+    _eventloop.add_rule(
+      "write bytes into shared inbound stream",
+      _shared_inbound->writable_fd(),
+      Direction::In,
+      [&] {
+        _shared_inbound->clear_writable();
+        _exchange_shared_streams();
+      },
+      [&] { return not _inbound_shutdown; } );
+  } else {
+    // rule 2: read from pipe into outbound buffer
+    _eventloop.add_rule(
+      "push bytes to TCPPeer",
+      _thread_data,
+      Direction::In,
+      [&] {
+        string data;
+        data.resize( min( _tcp->outbound_writer().available_capacity(), MAX_READ_SIZE ) );
+        _thread_data.read( data );
+        _tcp->outbound_writer().push( move( data ) );
+
+        if ( _thread_data.eof() ) {
+          _tcp->outbound_writer().close();
+          _outbound_shutdown = true;
+
+          // debugging output:
+          cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string()
+               << " finished (" << _tcp.value().sender().sequence_numbers_in_flight() << " seqno"
+               << ( _tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s" )
+               << " still in flight).\n";
+        }
+
+        _tcp->push();
+        collect_segments();
+        _outbound_writable = _tcp->outbound_writer().is_writable();
+      },
+      [&] { return ( _tcp->active() ) and ( not _outbound_shutdown ) and _outbound_writable; },
+      [&] {
         _tcp->outbound_writer().close();
         _outbound_shutdown = true;
+      } );
+
+    // rule 3: read from inbound buffer into pipe
+    _eventloop.add_rule(
+      "read bytes from inbound stream",
+      _thread_data,
+      Direction::Out,
+      [&] {
+        Reader& inbound = _tcp->inbound_reader();
+        // Write from the inbound_stream into
+        // the pipe, handling the possibility of a partial
+        // write (i.e., only pop what was actually written).
+        if ( inbound.bytes_buffered() ) {
+          drain( inbound, _thread_data );
+        }
+
+        if ( inbound.is_finished() or inbound.has_error() ) {
+          _thread_data.shutdown( SHUT_WR );
+          _inbound_shutdown = true;
+
+          // debugging output:
+          cerr << "DEBUG: Inbound stream from " << _datagram_adapter.config().destination.to_string()
+               << " finished " << ( inbound.has_error() ? "with an error/reset.\n" : "cleanly.\n" );
+        }
+        _inbound_readable = inbound.is_readable();
+      },
+      [&] { return _inbound_readable and not _inbound_shutdown; } );
+  }
 
-        // debugging output:
-        cerr << "DEBUG: Outbound stream to " << _datagram_adapter.config().destination.to_string() << " finished ("
-             << _tcp.value().sender().sequence_numbers_in_flight() << " seqno"
-             << ( _tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s" ) << " still in flight).\n";
-      }
-
-      _tcp->push();
-      collect_segments();
-    },
+  // rule 5: flush the outbound stream, after taking in what the owner wrote before asking (rule 2 comes first)
+  _eventloop.add_rule(
+    "flush TCPPeer",
+    _flush_request,
+    Direction::In,
     [&] {
-      return ( _tcp->active() ) and ( not _outbound_shutdown )
-             and ( _tcp->outbound_writer().available_capacity() > 0 );
+      _flush_request.clear();
+      _exchange_shared_streams();
+      _tcp->flush();
+      collect_segments();
     },
-    [&] {
-      _tcp->outbound_writer().close();
-      _outbound_shutdown = true;
-    } );
+    [&] { return _tcp->active(); } );
 
-  // rule 3: read from inbound buffer into pipe
+  // The owner's destructor signals this, so that a sleeping _tcp_loop notices _abort at once.
   _eventloop.add_rule(
-    "read bytes from inbound stream",
-    _thread_data,
-    Direction::Out,
-    [&] {
-      Reader& inbound = _tcp->inbound_reader();
-      // Write from the inbound_stream into
-      // the pipe, handling the possibility of a partial
-      // write (i.e., only pop what was actually written).
-      if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
-        inbound.pop( bytes_written );
-      }
-
-      if ( inbound.is_finished() or inbound.has_error() ) {
-        _thread_data.shutdown( SHUT_WR );
-        _inbound_shutdown = true;
-
-        // debugging output:
-        cerr << "DEBUG: Inbound stream from " << _datagram_adapter.config().destination.to_string() << " finished "
-             << ( inbound.has_error() ? "with an error/reset.\n" : "cleanly.\n" );
-      }
-    },
-    [&] {
-      return _tcp->inbound_reader().bytes_buffered()
-             or ( ( _tcp->inbound_reader().is_finished() or _tcp->inbound_reader().has_error() )
-                  and not _inbound_shutdown );
-    } );
+    "abort TCPPeer thread",
+    _abort_request,
+    Direction::In,
+    [&] { _abort_request.clear(); },
+    [&] { return _tcp->active(); } );
 
   // rule 4: read outbound segments from TCPConnection and send as datagrams
   _eventloop.add_rule(
@@ -210,6 +268,7 @@ TCPMinnowSocket<AdaptT>::~TCPMinnowSocket()
       cerr << "Warning: unclean shutdown of TCPMinnowSocket\n";
       // force the other side to exit
       _abort.store( true );
+      _abort_request.notify();
       _tcp_thread.join();
     }
   } catch ( const exception& e ) {
@@ -221,6 +280,9 @@ template<typename AdaptT>
 void TCPMinnowSocket<AdaptT>::wait_until_closed()
 {
   shutdown( SHUT_RDWR );
+  if ( _shared_outbound.has_value() ) {
+    _shared_outbound->close();
+  }
   if ( _tcp_thread.joinable() ) {
     cerr << "DEBUG: Waiting for clean shutdown... ";
     _tcp_thread.join();
@@ -294,6 +356,9 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     }
     _tcp_loop( [] { return true; } );
     shutdown( SHUT_RDWR );
+    if ( _shared_inbound.has_value() and not _inbound_shutdown ) {
+      _shared_inbound->set_error(); // wake an owner blocked on inbound_stream()
+    }
     if ( not _tcp.value().active() ) {
       cerr << "DEBUG: TCP connection finished "
            << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
@@ -305,6 +370,96 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
   }
 }
 
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::use_shared_streams( uint64_t capacity )
+{
+  if ( _tcp ) {
+    throw runtime_error( "use_shared_streams() with TCPConnection already initialized" );
+  }
+
+  _shared_outbound.emplace( capacity );
+  _shared_inbound.emplace( capacity );
+}
+
+template<typename AdaptT>
+SPSCByteStream& TCPMinnowSocket<AdaptT>::outbound_stream()
+{
+  if ( not _shared_outbound.has_value() ) {
+    throw runtime_error( "outbound_stream() without use_shared_streams()" );
+  }
+  return _shared_outbound.value();
+}
+
+template<typename AdaptT>
+SPSCByteStream& TCPMinnowSocket<AdaptT>::inbound_stream()
+{
+  if ( not _shared_inbound.has_value() ) {
+    throw runtime_error( "inbound_stream() without use_shared_streams()" );
+  }
+  return _shared_inbound.value();
+}
+
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::flush()
+{
+  _flush_request.notify();
+}
+
+template<typename AdaptT>
+void TCPMinnowSocket<AdaptT>::_exchange_shared_streams()
+{
+  if ( not _shared_outbound.has_value() or not _tcp.has_value() ) {
+    return;
+  }
+
+  // Until the TCPPeer's streams raise these again, the owner's eventfds say when there is more to move.
+  _outbound_writable = false;
+  _inbound_readable = false;
+
+  // owner -> TCPPeer
+  SPSCByteStream& from_owner = _shared_outbound.value();
+  Writer& outbound = _tcp->outbound_writer();
+  if ( not _outbound_shutdown ) {
+    bool pushed = false;
+    while ( from_owner.bytes_buffered() and outbound.available_capacity() ) {
+      const auto data = from_owner.peek().substr( 0, outbound.available_capacity() );
+      outbound.push( string( data ) );
+      from_owner.pop( data.size() );
+      pushed = true;
+    }
+
+    if ( from_owner.has_error() ) {
+      outbound.set_error();
+      _outbound_shutdown = true;
+    } else if ( from_owner.is_finished() ) {
+      outbound.close();
+      _outbound_shutdown = true;
+    }
+
+    if ( pushed or _outbound_shutdown ) {
+      _tcp->push();
+      collect_segments();
+    }
+  }
+
+  // TCPPeer -> owner
+  SPSCByteStream& to_owner = _shared_inbound.value();
+  Reader& inbound = _tcp->inbound_reader();
+  if ( not _inbound_shutdown ) {
+    while ( inbound.bytes_buffered() and to_owner.available_capacity() ) {
+      inbound.pop( to_owner.push( inbound.peek() ) );
+    }
+
+    if ( inbound.has_error() ) {
+      to_owner.set_error();
+      _inbound_shutdown = true;
+    } else if ( inbound.is_finished() ) {
+      to_owner.close();
+      _inbound_shutdown = true;
+    }
+  }
+}
+
 template<typename AdaptT>
 void TCPMinnowSocket<AdaptT>::collect_segments()
 {
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "eventfd.hh"
 #include "eventloop.hh"
 #include "file_descriptor.hh"
 #include "network_interface.hh"
 #include "socket.hh"
+#include "spsc_byte_stream.hh"
 #include "tcp_config.hh"
 #include "tcp_peer.hh"
 #include "tuntap_adapter.hh"
@@ -60,8 +62,26 @@ private:
 
   bool _fully_acked { false }; //!< Has the outbound data been fully acknowledged by the peer?
 
+  //! \name
+  //! Raised by the TCPPeer's byte streams when they have room for the owner's bytes, or bytes for the owner, and
+  //! lowered by the rules that move those bytes once they have moved what they can
+
+  //!@{
+  bool _outbound_writable { true };
+  bool _inbound_readable { false };
+  //!@}
+
   void collect_segments(); //!< Drain segments from the TCPPeer
 
+  //! Shared-memory streams that replace _thread_data when use_shared_streams() is in effect
+  std::optional<SPSCByteStream> _shared_outbound {}, _shared_inbound {};
+
+  //! Move bytes between the shared-memory streams and the TCPPeer (TCPPeer thread only)
+  void _exchange_shared_streams();
+
+  EventFD _flush_request {}; //!< Signalled by the owner's flush(), for the TCPPeer thread
+  EventFD _abort_request {}; //!< Signalled along with _abort, to wake the TCPPeer thread
+
 public:
   //! Construct from the interface that the TCPPeer thread will use to read and write datagrams
   explicit TCPMinnowSocket( AdaptT&& datagram_interface );
@@ -77,6 +97,23 @@ public:
   //! Listen and accept using the specified configurations; blocks until accept succeeds or fails
   void listen_and_accept( const TCPConfig& c_tcp, const FdAdapterConfig& c_ad );
 
+  //! \brief Exchange data with the TCPPeer thread through lock-free shared-memory streams
+  //! \details Instead of writing to and reading from this socket, the owner pushes to outbound_stream()
+  //! and pops from inbound_stream(). Must be called before connect() or listen_and_accept().
+  void use_shared_streams( uint64_t capacity = TCPConfig::DEFAULT_CAPACITY );
+
+  //! Bytes for the TCPPeer to send (the owner is the writer); requires use_shared_streams()
+  SPSCByteStream& outbound_stream();
+
+  //! Bytes received by the TCPPeer (the owner is the reader); requires use_shared_streams()
+  SPSCByteStream& inbound_stream();
+
+  //! \brief Send what has been written so far, even a short segment that TCPConfig::cork (or Nagle's algorithm,
+  //! or autocork) would hold back
+  //! \details Returns at once; the TCPPeer thread flushes the bytes it has taken from the owner by then (with
+  //! shared streams, every byte pushed before the call).
+  void flush();
+
   //! When a connected socket is destructed, it will send a RST
   ~TCPMinnowSocket();
 
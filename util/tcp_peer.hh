@@ -7,28 +7,90 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 class TCPPeer
 {
   TCPConfig cfg_;
-  TCPSender sender_ { cfg_.rt_timeout, cfg_.fixed_isn };
+  TCPSender sender_ { cfg_.rt_timeout, cfg_.fixed_isn, cfg_.congestion_control };
   TCPReceiver receiver_ {};
-  Reassembler reassembler_ {};
+  Reassembler reassembler_ { cfg_.reassembler_engine };
 
-  ByteStream outbound_stream_ { cfg_.send_capacity }, inbound_stream_ { cfg_.recv_capacity };
+  ByteStream outbound_stream_ { cfg_.send_capacity, ByteStream::Storage::Chunked };
+  // The Direct engine places bytes in a ring; otherwise the inbound stream keeps segment payloads as they are.
+  ByteStream inbound_stream_ { cfg_.recv_capacity,
+                               cfg_.reassembler_engine == Reassembler::Engine::Direct
+                                 ? ByteStream::Storage::Ring
+                                 : ByteStream::Storage::Chunked };
 
   bool need_send_ {};
+  bool peer_sack_permitted_ {}; // the peer's SYN offered SACK, so our ACKs may carry SACK blocks
+
+  // The MSS we offer, from the local MTU less the IPv4 and TCP headers. What we send is the least of it and the
+  // peer's (RFC 9293 3.7.1, but at least TCPConfig::MIN_MSS), less the timestamps option on every segment, if
+  // agreed.
+  static constexpr uint16_t HEADERS_LENGTH = TCPConfig::MIN_MTU - TCPConfig::MIN_MSS;
+  static constexpr uint16_t DEFAULT_PEER_MSS = 536; // if the peer's SYN offers none
+  static constexpr uint16_t TIMESTAMPS_LENGTH = 12;
+  uint16_t mss_ { mss_for( cfg_.mtu ) };
+
+  static uint16_t mss_for( uint16_t mtu )
+  {
+    if ( mtu < TCPConfig::MIN_MTU ) {
+      throw std::runtime_error( "TCPConfig::mtu below " + std::to_string( TCPConfig::MIN_MTU ) );
+    }
+    return mtu - HEADERS_LENGTH;
+  }
+
+  // Window scaling (RFC 7323): the shift we offer, enough for recv_capacity, and the one the peer's SYN offered
+  uint8_t window_shift_ { window_shift_for( cfg_.recv_capacity ) };
+  std::optional<uint8_t> peer_window_shift_ {};
+
+  static uint8_t window_shift_for( uint64_t capacity )
+  {
+    uint8_t shift = 0;
+    while ( shift < TCPReceiverMessage::MAX_WINDOW_SHIFT and ( capacity >> shift ) > UINT16_MAX ) {
+      shift++;
+    }
+    return shift;
+  }
 
 public:
-  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
+  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg )
+  {
+    reassembler_.set_pending_limit( cfg_.reassembler_limit );
+    sender_.set_pacing( cfg_.pacing );
+    sender_.set_nagle( cfg_.nagle );
+    sender_.set_autocork( cfg_.autocork );
+    sender_.set_cork( cfg_.cork );
+    sender_.set_timestamps( cfg_.timestamps ); // offered on our SYN; kept only if the peer's SYN has one too
+    if ( cfg_.adaptive_rto ) {
+      sender_.set_adaptive_RTO( cfg_.rto_min, cfg_.rto_max );
+    }
+  }
 
   Writer& outbound_writer() { return outbound_stream_.writer(); }
   Reader& inbound_reader() { return inbound_stream_.reader(); }
 
   void push() { sender_.push( outbound_stream_.reader() ); };
+  void flush() { sender_.flush( outbound_stream_.reader() ); } // send even a short segment that would be held
   void tick( uint64_t ms_since_last_tick ) { sender_.tick( ms_since_last_tick ); }
 
+  // How long until the sender has something to do: pacing lets it send more, or its retransmission timer expires
+  std::optional<uint64_t> ms_until_next_timer() const
+  {
+    const auto send = sender_.ms_until_next_send();
+    const auto timeout = sender_.ms_until_timeout();
+    if ( send.has_value() and timeout.has_value() ) {
+      return std::min( send.value(), timeout.value() );
+    }
+    return send.has_value() ? send : timeout;
+  }
+
   bool has_ackno() const { return receiver_.send( inbound_stream_.writer() ).ackno.has_value(); }
 
   bool active() const
@@ -47,11 +109,38 @@ public:
       return;
     }
 
-    // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( seg.receiver_message );
+    // The options are settled by the first SYN; a retransmitted one changes nothing (and cannot restart the path
+    // MTU search).
+    if ( seg.sender_message.SYN and not has_ackno() ) {
+      peer_sack_permitted_ = cfg_.sack and seg.sack_permitted;
+      peer_window_shift_ = cfg_.window_scaling ? seg.window_scale : std::nullopt;
+      const bool timestamps = cfg_.timestamps and seg.sender_message.timestamp.has_value();
+      sender_.set_timestamps( timestamps );
+      const uint16_t mss = std::min( mss_, std::max( seg.mss.value_or( DEFAULT_PEER_MSS ), TCPConfig::MIN_MSS ) );
+      sender_.set_mss( mss - ( timestamps ? TIMESTAMPS_LENGTH : 0 ) );
+      if ( cfg_.mtu_probing ) {
+        sender_.set_path_mtu_discovery( TCPConfig::MAX_PAYLOAD_SIZE );
+      }
+    }
+    if ( not cfg_.timestamps ) {
+      seg.sender_message.timestamp.reset();
+    }
+
+    // Once both SYNs offered window scaling, every window is scaled but a SYN's own. We scale ours as soon as the
+    // peer has acknowledged our SYN, after which we send no more SYNs.
+    if ( peer_window_shift_.has_value() ) {
+      sender_.set_window_scale( seg.sender_message.SYN ? 0 : peer_window_shift_.value() );
+      if ( seg.receiver_message.ackno.has_value() ) {
+        receiver_.set_window_scale( window_shift_ );
+      }
+    }
+
+    // Give incoming TCPReceiverMessage to sender. (An ACK that came with data is not a duplicate ACK.)
+    sender_.receive( seg.receiver_message, seg.sender_message.sequence_length() > 0 );
 
     // Give incoming TCPSenderMessage to receiver.
-    // If SenderMessage is non-empty or a keep-alive, make sure to reply.
+    // If SenderMessage is non-empty or a keep-alive, make sure to reply. Every segment is acknowledged at once,
+    // so each out-of-order segment draws a duplicate ACK, which the peer's sender needs for fast retransmit.
     need_send_ |= ( seg.sender_message.sequence_length() > 0 );
     const auto our_ackno = receiver_.send( inbound_stream_.writer() ).ackno;
     need_send_ |= ( our_ackno.has_value() and seg.sender_message.seqno + 1 == our_ackno.value() );
@@ -78,10 +167,33 @@ public:
 
     need_send_ = false;
 
-    // Send the segment
+    // Send the segment, offering options on a SYN and reporting what the Reassembler holds once SACK is agreed.
     if ( sender_msg.has_value() ) {
-      return TCPSegment {
-        sender_msg.value(), receiver_msg, outbound_stream_.reader().has_error() or inbound_reader().has_error() };
+      if ( peer_sack_permitted_ and reassembler_.bytes_pending() > 0 ) {
+        receiver_msg.sack_blocks = receiver_.sack_blocks( reassembler_ );
+        // (Only as many as fit beside the payload in a segment of the negotiated size: 8 bytes each, and 4 for the
+        // option.)
+        const uint64_t options = sender_msg->timestamp.has_value() ? TIMESTAMPS_LENGTH : 0;
+        const uint64_t room = sender_.mss() + options;
+        const uint64_t used = sender_msg->payload.size() + options;
+        const uint64_t fit = room > used + 4 ? ( room - used - 4 ) / 8 : 0;
+        if ( receiver_msg.sack_blocks.size() > fit ) {
+          receiver_msg.sack_blocks.erase( receiver_msg.sack_blocks.begin() + static_cast<ptrdiff_t>( fit ),
+                                          receiver_msg.sack_blocks.end() );
+        }
+      }
+      // (A SYN-ACK offers an option only in reply to a SYN that did.)
+      const bool offer_sack
+        = sender_msg->SYN and cfg_.sack and ( peer_sack_permitted_ or not receiver_msg.ackno.has_value() );
+      const bool offer_window_scale = sender_msg->SYN and cfg_.window_scaling
+                                      and ( peer_window_shift_.has_value() or not receiver_msg.ackno.has_value() );
+      const std::optional<uint16_t> offer_mss = sender_msg->SYN ? std::optional { mss_ } : std::nullopt;
+      return TCPSegment { .sender_message = std::move( sender_msg.value() ),
+                          .receiver_message = std::move( receiver_msg ),
+                          .reset = outbound_stream_.reader().has_error() or inbound_reader().has_error(),
+                          .sack_permitted = offer_sack,
+                          .window_scale = offer_window_scale ? std::optional { window_shift_ } : std::nullopt,
+                          .mss = offer_mss };
     }
 
     return {};
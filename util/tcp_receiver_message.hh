@@ -2,23 +2,46 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains four fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header), unless both sides agreed to scale it (RFC 7323): then it counts units
+ *    of 2^shift bytes, for a shift of up to MAX_WINDOW_SHIFT.
+ *
+ * 3) The SACK blocks (RFC 2018): runs of sequence numbers past the ackno that the TCP receiver already
+ *    holds, so that the sender need not retransmit them. The first block holds the most recently received
+ *    segment. Empty unless both sides agreed to use SACK.
+ *
+ * 4) The timestamp echo (RFC 7323 TSecr): the timestamp of the latest segment that arrived at the left edge
+ *    of the window. Empty unless the sender's segments carry timestamps.
  */
 
+// A run of sequence numbers, from `left` up to (but not including) `right`
+struct SACKBlock
+{
+  Wrap32 left;
+  Wrap32 right;
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4;   // as many as fit in the TCP header's options
+  static constexpr uint8_t MAX_WINDOW_SHIFT = 14; // a scaled window stays under 2^30 bytes
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::vector<SACKBlock> sack_blocks {};
+  std::optional<uint32_t> timestamp_echo {};
 };
@@ -2,12 +2,87 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
-static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr uint32_t TCPHeaderMinLen = 5;  // 32-bit words
+static constexpr uint32_t TCPHeaderMaxLen = 15; // 32-bit words
+
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNop = 1;
+static constexpr uint8_t TCPOptionMSS = 2;
+static constexpr uint8_t TCPOptionWindowScale = 3;
+static constexpr uint8_t TCPOptionSACKPermitted = 4;
+static constexpr uint8_t TCPOptionSACK = 5;
+static constexpr uint8_t TCPOptionTimestamps = 8;
 
 using namespace std;
 
+// Parse `len` bytes of options. Options we do not know are skipped, and so is the rest of a malformed list.
+static void parse_options( TCPSegment& seg, Parser& parser, uint64_t len )
+{
+  while ( len > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    len--;
+    if ( kind == TCPOptionEnd ) {
+      break;
+    }
+    if ( kind == TCPOptionNop ) {
+      continue;
+    }
+
+    if ( len == 0 ) {
+      break;
+    }
+    uint8_t option_len {};
+    parser.integer( option_len );
+    len--;
+    if ( option_len < 2 or option_len - 2U > len ) {
+      break;
+    }
+    uint64_t body_len = option_len - 2U;
+    len -= body_len;
+
+    if ( kind == TCPOptionMSS and body_len == 2 ) {
+      uint16_t mss {};
+      parser.integer( mss );
+      body_len -= 2;
+      if ( mss > 0 ) { // (an MSS of 0 is nonsense, and is ignored)
+        seg.mss = mss;
+      }
+    } else if ( kind == TCPOptionWindowScale and body_len == 1 ) {
+      uint8_t shift {};
+      parser.integer( shift );
+      body_len--;
+      seg.window_scale = min( shift, TCPReceiverMessage::MAX_WINDOW_SHIFT ); // RFC 7323 2.3
+    } else if ( kind == TCPOptionSACKPermitted and body_len == 0 ) {
+      seg.sack_permitted = true;
+    } else if ( kind == TCPOptionTimestamps and body_len == 8 ) {
+      uint32_t value {};
+      uint32_t echo {};
+      parser.integer( value );
+      parser.integer( echo );
+      body_len -= 8;
+      seg.sender_message.timestamp = value;
+      if ( seg.receiver_message.ackno.has_value() ) { // the echo is meaningless without an ACK
+        seg.receiver_message.timestamp_echo = echo;
+      }
+    } else if ( kind == TCPOptionSACK and body_len % 8 == 0 ) {
+      for ( ; body_len > 0; body_len -= 8 ) {
+        uint32_t left {};
+        uint32_t right {};
+        parser.integer( left );
+        parser.integer( right );
+        seg.receiver_message.sack_blocks.push_back( { Wrap32 { left }, Wrap32 { right } } );
+      }
+    }
+    parser.remove_prefix( body_len );
+  }
+  parser.remove_prefix( len );
+}
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   {
@@ -52,11 +127,11 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( *this, parser, data_offset * 4 - TCPHeaderMinLen * 4 );
 
   parser.all_remaining( sender_message.payload );
 }
@@ -67,19 +142,75 @@ public:
   uint32_t raw_value() const { return raw_value_; }
 };
 
+// How many of the SACK blocks fit in the options, after the others
+static uint64_t sack_blocks_that_fit( const TCPSegment& seg )
+{
+  const uint64_t room = ( TCPHeaderMaxLen - TCPHeaderMinLen ) * 4 - ( seg.mss.has_value() ? 4 : 0 )
+                        - ( seg.sack_permitted ? 4 : 0 ) - ( seg.window_scale.has_value() ? 4 : 0 )
+                        - ( seg.sender_message.timestamp.has_value() ? 12 : 0 ) - 4;
+  return min( static_cast<uint64_t>( seg.receiver_message.sack_blocks.size() ), room / 8 );
+}
+
+uint64_t TCPSegment::header_length() const
+{
+  const uint64_t sack_blocks = sack_blocks_that_fit( *this );
+  return TCPHeaderMinLen * 4 + ( mss.has_value() ? 4 : 0 ) + ( window_scale.has_value() ? 4 : 0 )
+         + ( sack_permitted ? 4 : 0 )
+         + ( sender_message.timestamp.has_value() ? 12 : 0 ) + ( sack_blocks > 0 ? 4 + 8 * sack_blocks : 0 );
+}
+
 void TCPSegment::serialize( Serializer& serializer ) const
 {
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { sender_message.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { receiver_message.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( header_length() / 4 << 4 ) ); // data offset
   const uint8_t flags = ( receiver_message.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( sender_message.SYN ? 0b0000'0010U : 0 ) | ( sender_message.FIN ? 0b0000'0001U : 0 );
   serializer.integer( flags );
   serializer.integer( receiver_message.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+
+  // Each option is padded with NOPs to a whole number of 32-bit words.
+  if ( mss.has_value() ) {
+    serializer.integer( TCPOptionMSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( mss.value() );
+  }
+  if ( window_scale.has_value() ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionWindowScale );
+    serializer.integer( uint8_t { 3 } );
+    serializer.integer( window_scale.value() );
+  }
+  if ( sender_message.timestamp.has_value() ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionTimestamps );
+    serializer.integer( uint8_t { 10 } );
+    serializer.integer( sender_message.timestamp.value() );
+    serializer.integer( receiver_message.timestamp_echo.value_or( 0 ) );
+  }
+  if ( sack_permitted ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACKPermitted );
+    serializer.integer( uint8_t { 2 } );
+  }
+  const uint64_t sack_blocks = sack_blocks_that_fit( *this );
+  if ( sack_blocks > 0 ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACK );
+    serializer.integer( static_cast<uint8_t>( 2 + 8 * sack_blocks ) );
+    for ( uint64_t i = 0; i < sack_blocks; i++ ) {
+      serializer.integer( Wrap32Serializable { receiver_message.sack_blocks[i].left }.raw_value() );
+      serializer.integer( Wrap32Serializable { receiver_message.sack_blocks[i].right }.raw_value() );
+    }
+  }
+
   serializer.buffer( sender_message.payload );
 }
 
@@ -5,15 +5,22 @@
 #include "tcp_sender_message.hh"
 #include "udinfo.hh"
 
+#include <cstdint>
+#include <optional>
+
 struct TCPSegment
 {
   TCPSenderMessage sender_message {};
   TCPReceiverMessage receiver_message {};
-  bool reset {}; // Connection experienced an abnormal error and should be shut down
+  bool reset {};                          // Connection experienced an abnormal error and should be shut down
+  bool sack_permitted {};                 // On a SYN: the sender of this segment understands SACK blocks (RFC 2018)
+  std::optional<uint8_t> window_scale {}; // On a SYN: the shift its sender will apply to its windows (RFC 7323)
+  std::optional<uint16_t> mss {};         // On a SYN: the largest payload its sender will accept (RFC 9293 3.7.1)
   UserDatagramInfo udinfo {};
 
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
+  uint64_t header_length() const; // in bytes, with the options serialize() will write
 
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 };